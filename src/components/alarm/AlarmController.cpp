@@ -24,8 +24,10 @@
 using namespace Pinetime::Controllers;
 using namespace std::chrono_literals;
 
-AlarmController::AlarmController(Controllers::DateTime& dateTimeController, Controllers::FS& fs)
-  : dateTimeController {dateTimeController}, fs {fs} {
+AlarmController::AlarmController(Controllers::DateTime& dateTimeController,
+                                 Controllers::FS& fs,
+                                 Controllers::ChangeNotifier& changeNotifier)
+  : dateTimeController {dateTimeController}, fs {fs}, changeNotifier {changeNotifier} {
 }
 
 namespace {
@@ -102,6 +104,7 @@ void AlarmController::ScheduleAlarm() {
   if (!alarm.isEnabled) {
     alarm.isEnabled = true;
     alarmChanged = true;
+    changeNotifier.Notify(ChangeNotifier::Topics::Alarm);
   }
 }
 
@@ -114,11 +117,13 @@ void AlarmController::DisableAlarm() {
   if (alarm.isEnabled) {
     alarm.isEnabled = false;
     alarmChanged = true;
+    changeNotifier.Notify(ChangeNotifier::Topics::Alarm);
   }
 }
 
 void AlarmController::SetOffAlarmNow() {
   isAlerting = true;
+  changeNotifier.Notify(ChangeNotifier::Topics::Alarm);
   systemTask->PushMessage(System::Messages::SetOffAlarm);
 }
 
@@ -128,6 +133,7 @@ void AlarmController::StopAlerting() {
   if (alarm.recurrence == RecurType::None) {
     alarm.isEnabled = false;
     alarmChanged = true;
+    changeNotifier.Notify(ChangeNotifier::Topics::Alarm);
   } else {
     // set next instance
     ScheduleAlarm();
@@ -30,7 +30,7 @@ namespace Pinetime {
   namespace Controllers {
     class AlarmController {
     public:
-      AlarmController(Controllers::DateTime& dateTimeController, Controllers::FS& fs);
+      AlarmController(Controllers::DateTime& dateTimeController, Controllers::FS& fs, Controllers::ChangeNotifier& changeNotifier);
 
       void Init(System::SystemTask* systemTask);
       void SaveAlarm();
@@ -82,6 +82,7 @@ namespace Pinetime {
 
       Controllers::DateTime& dateTimeController;
       Controllers::FS& fs;
+      Controllers::ChangeNotifier& changeNotifier;
       System::SystemTask* systemTask = nullptr;
       TimerHandle_t alarmTimer;
       AlarmSettings alarm;
@@ -8,10 +8,12 @@ bool Ble::IsConnected() const {
 
 void Ble::Connect() {
   isConnected = true;
+  changeNotifier.Notify(ChangeNotifier::Topics::Ble);
 }
 
 void Ble::Disconnect() {
   isConnected = false;
+  changeNotifier.Notify(ChangeNotifier::Topics::Ble);
 }
 
 bool Ble::IsRadioEnabled() const {
@@ -20,10 +22,12 @@ bool Ble::IsRadioEnabled() const {
 
 void Ble::EnableRadio() {
   isRadioEnabled = true;
+  changeNotifier.Notify(ChangeNotifier::Topics::Ble);
 }
 
 void Ble::DisableRadio() {
   isRadioEnabled = false;
+  changeNotifier.Notify(ChangeNotifier::Topics::Ble);
 }
 
 void Ble::StartFirmwareUpdate() {
@@ -2,6 +2,7 @@
 
 #include <array>
 #include <cstdint>
+#include "components/changenotifier/ChangeNotifier.h"
 
 namespace Pinetime {
   namespace Controllers {
@@ -11,7 +12,9 @@ namespace Pinetime {
       enum class FirmwareUpdateStates { Idle, Running, Validated, Error };
       enum class AddressTypes { Public, Random, RPA_Public, RPA_Random };
 
-      Ble() = default;
+      explicit Ble(ChangeNotifier& changeNotifier) : changeNotifier {changeNotifier} {
+      }
+
       bool IsConnected() const;
       void Connect();
       void Disconnect();
@@ -66,6 +69,7 @@ namespace Pinetime {
       }
 
     private:
+      ChangeNotifier& changeNotifier;
       bool isConnected = false;
       bool isRadioEnabled = true;
       bool isFirmwareUpdating = false;
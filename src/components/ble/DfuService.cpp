@@ -386,16 +386,34 @@ void DfuService::DfuImage::Append(uint8_t* data, size_t size) {
   bufferWriteIndex += size;
 
   if (bufferWriteIndex == bufferSize) {
-    spiNorFlash.Write(writeOffset + totalWriteIndex, tempBuffer, bufferWriteIndex);
-    totalWriteIndex += bufferWriteIndex;
-    bufferWriteIndex = 0;
+    WriteBuffer();
   }
 
   if (bufferWriteIndex > 0 && totalWriteIndex + bufferWriteIndex == totalSize) {
-    spiNorFlash.Write(writeOffset + totalWriteIndex, tempBuffer, bufferWriteIndex);
-    totalWriteIndex += bufferWriteIndex;
+    WriteBuffer();
+  }
+
+  if (totalWriteIndex == totalSize) {
+    // The rest of the area holds the trailer read by the bootloader, it must be erased as well
+    spiNorFlash.EraseRange(writeOffset + erasedSize, maxSize - erasedSize);
+    erasedSize = maxSize;
     if (totalSize < maxSize)
       WriteMagicNumber();
+  } else if (erasedSize < maxSize && erasedSize < totalWriteIndex + eraseAhead && !spiNorFlash.IsErasing()) {
+    erasedSize += spiNorFlash.StartErase(writeOffset + erasedSize, sectorSize);
+  }
+}
+
+void DfuService::DfuImage::WriteBuffer() {
+  EraseUntil(totalWriteIndex + bufferWriteIndex);
+  spiNorFlash.Write(writeOffset + totalWriteIndex, tempBuffer, bufferWriteIndex);
+  totalWriteIndex += bufferWriteIndex;
+  bufferWriteIndex = 0;
+}
+
+void DfuService::DfuImage::EraseUntil(size_t size) {
+  while (erasedSize < size) {
+    erasedSize += spiNorFlash.StartErase(writeOffset + erasedSize, sectorSize);
   }
 }
 
@@ -413,9 +431,7 @@ void DfuService::DfuImage::WriteMagicNumber() {
 }
 
 void DfuService::DfuImage::Erase() {
-  for (size_t erased = 0; erased < maxSize; erased += 0x1000) {
-    spiNorFlash.SectorErase(writeOffset + erased);
-  }
+  erasedSize = spiNorFlash.StartErase(writeOffset, sectorSize);
 }
 
 bool DfuService::DfuImage::Validate() {
@@ -57,6 +57,8 @@ namespace Pinetime {
         }
 
         void Init(size_t chunkSize, size_t totalSize, uint16_t expectedCrc);
+        // Starts erasing the OTA area. The area is erased in the background, a few sectors ahead of the
+        // data written, so that the erase time overlaps with the reception of the image.
         void Erase();
         void Append(uint8_t* data, size_t size);
         bool Validate();
@@ -72,9 +74,15 @@ namespace Pinetime {
         size_t bufferWriteIndex = 0;
         size_t totalWriteIndex = 0;
         static constexpr size_t writeOffset = 0x40000;
+        static constexpr size_t sectorSize = 0x1000;
+        static constexpr size_t eraseAhead = 2 * sectorSize;
         uint8_t tempBuffer[bufferSize];
         uint16_t expectedCrc = 0;
+        // Size of the OTA area erased or being erased
+        size_t erasedSize = 0;
 
+        void WriteBuffer();
+        void EraseUntil(size_t size);
         void WriteMagicNumber();
         uint16_t ComputeCrc(uint8_t const* p_data, uint32_t size, uint16_t const* p_crc);
       };
@@ -1,3 +1,5 @@
+#include <cstddef>
+#include <limits>
 #include <nrf_log.h>
 #include "FSService.h"
 #include "components/ble/BleController.h"
@@ -16,6 +18,11 @@ int FSServiceCallback(uint16_t conn_handle, uint16_t attr_handle, struct ble_gat
   return fsService->OnFSServiceRequested(conn_handle, attr_handle, ctxt);
 }
 
+void SessionTimerCallback(TimerHandle_t xTimer) {
+  auto* fsService = static_cast<FSService*>(pvTimerGetTimerID(xTimer));
+  fsService->OnSessionTimeout();
+}
+
 FSService::FSService(Pinetime::System::SystemTask& systemTask, Pinetime::Controllers::FS& fs)
   : systemTask {systemTask},
     fs {fs},
@@ -28,7 +35,8 @@ FSService::FSService(Pinetime::System::SystemTask& systemTask, Pinetime::Control
                                 .uuid = &fsTransferUuid.u,
                                 .access_cb = FSServiceCallback,
                                 .arg = this,
-                                .flags = BLE_GATT_CHR_F_WRITE | BLE_GATT_CHR_F_READ | BLE_GATT_CHR_F_NOTIFY,
+                                .flags = BLE_GATT_CHR_F_WRITE | BLE_GATT_CHR_F_WRITE_NO_RSP | BLE_GATT_CHR_F_READ |
+                                         BLE_GATT_CHR_F_NOTIFY,
                                 .val_handle = &transferCharacteristicHandle,
                               },
                               {0}},
@@ -39,6 +47,7 @@ FSService::FSService(Pinetime::System::SystemTask& systemTask, Pinetime::Control
        .characteristics = characteristicDefinition},
       {0},
     } {
+  sessionTimer = xTimerCreate("fsSessionTimer", sessionTimeout, pdFALSE, this, SessionTimerCallback);
 }
 
 void FSService::Init() {
@@ -69,7 +78,10 @@ int FSService::OnFSServiceRequested(uint16_t connectionHandle, uint16_t attribut
     return (res == 0) ? 0 : BLE_ATT_ERR_INSUFFICIENT_RES;
   }
   if (attributeHandle == transferCharacteristicHandle) {
-    return FSCommandHandler(connectionHandle, context->om);
+    StartSession();
+    int res = FSCommandHandler(connectionHandle, context->om);
+    xTimerStart(sessionTimer, 0);
+    return res;
   }
   return 0;
 }
@@ -77,15 +89,8 @@ int FSService::OnFSServiceRequested(uint16_t connectionHandle, uint16_t attribut
 int FSService::FSCommandHandler(uint16_t connectionHandle, os_mbuf* om) {
   auto command = static_cast<commands>(om->om_data[0]);
   NRF_LOG_INFO("[FS_S] -> FSCommandHandler Command %d", command);
-  // Just always make sure we are awake...
-  systemTask.PushMessage(Pinetime::System::Messages::StartFileTransfer);
-  vTaskDelay(10);
-  while (systemTask.IsSleeping()) {
-    vTaskDelay(100); // 50ms
-  }
   lfs_dir_t dir = {0};
   lfs_info info = {0};
-  lfs_file f = {0};
   switch (command) {
     case commands::READ: {
       NRF_LOG_INFO("[FS_S] -> Read");
@@ -94,64 +99,43 @@ int FSService::FSCommandHandler(uint16_t connectionHandle, os_mbuf* om) {
       if (plen > maxpathlen) { //> counts for null term
         return -1;
       }
+      CloseTransferFile();
       memcpy(filepath, header->pathstr, plen);
       filepath[plen] = 0; // Copy and null terminate string
-      ReadResponse resp;
-      os_mbuf* om;
-      resp.command = commands::READ_DATA;
-      resp.status = 0x01;
-      resp.chunkoff = header->chunkoff;
+      state = FSState::READ;
       int res = fs.Stat(filepath, &info);
-      if (res == LFS_ERR_NOENT && info.type != LFS_TYPE_DIR) {
-        resp.status = (int8_t) res;
-        resp.chunklen = 0;
-        resp.totallen = 0;
-        om = ble_hs_mbuf_from_flat(&resp, sizeof(ReadResponse));
-      } else {
-        resp.chunklen = std::min(header->chunksize, info.size); // TODO add mtu somehow
-        resp.totallen = info.size;
-        fs.FileOpen(&f, filepath, LFS_O_RDONLY);
-        fs.FileSeek(&f, header->chunkoff);
-        uint8_t fileData[resp.chunklen] = {0};
-        resp.chunklen = fs.FileRead(&f, fileData, resp.chunklen);
-        om = ble_hs_mbuf_from_flat(&resp, sizeof(ReadResponse));
-        os_mbuf_append(om, fileData, resp.chunklen);
-        fs.FileClose(&f);
+      if ((res == LFS_ERR_NOENT && info.type != LFS_TYPE_DIR) || OpenTransferFile(LFS_O_RDONLY) < 0) {
+        ReadResponse resp {};
+        resp.command = commands::READ_DATA;
+        resp.status = (int8_t) LFS_ERR_NOENT;
+        resp.chunkoff = header->chunkoff;
+        auto* om = ble_hs_mbuf_from_flat(&resp, sizeof(ReadResponse));
+        ble_gattc_notify_custom(connectionHandle, transferCharacteristicHandle, om);
+        break;
       }
-
-      ble_gattc_notify_custom(connectionHandle, transferCharacteristicHandle, om);
+      fileSize = info.size;
+      SendReadData(connectionHandle, header->chunkoff, header->chunksize, fileSize);
       break;
     }
     case commands::READ_PACING: {
       NRF_LOG_INFO("[FS_S] -> Readpacing");
       auto* header = (ReadHeader*) om->om_data;
-      ReadResponse resp;
-      resp.command = commands::READ_DATA;
-      resp.status = 0x01;
-      resp.chunkoff = header->chunkoff;
-      int res = fs.Stat(filepath, &info);
-      if (res == LFS_ERR_NOENT && info.type != LFS_TYPE_DIR) {
-        resp.status = (int8_t) res;
-        resp.chunklen = 0;
-        resp.totallen = 0;
-      } else {
-        resp.chunklen = std::min(header->chunksize, info.size); // TODO add mtu somehow
-        resp.totallen = info.size;
-        fs.FileOpen(&f, filepath, LFS_O_RDONLY);
-        fs.FileSeek(&f, header->chunkoff);
+      // The file is closed once it has been read entirely, but the client may read it again
+      bool opened = transferFileOpened;
+      if (!opened && state == FSState::READ && fs.Stat(filepath, &info) == 0 && OpenTransferFile(LFS_O_RDONLY) == 0) {
+        fileSize = info.size;
+        opened = true;
       }
-      os_mbuf* om;
-      if (resp.chunklen > 0) {
-        uint8_t fileData[resp.chunklen] = {0};
-        resp.chunklen = fs.FileRead(&f, fileData, resp.chunklen);
-        om = ble_hs_mbuf_from_flat(&resp, sizeof(ReadResponse));
-        os_mbuf_append(om, fileData, resp.chunklen);
-      } else {
-        resp.chunklen = 0;
-        om = ble_hs_mbuf_from_flat(&resp, sizeof(ReadResponse));
+      if (state != FSState::READ || !opened) {
+        ReadResponse resp {};
+        resp.command = commands::READ_DATA;
+        resp.status = (int8_t) LFS_ERR_NOENT;
+        resp.chunkoff = header->chunkoff;
+        auto* om = ble_hs_mbuf_from_flat(&resp, sizeof(ReadResponse));
+        ble_gattc_notify_custom(connectionHandle, transferCharacteristicHandle, om);
+        break;
       }
-      fs.FileClose(&f);
-      ble_gattc_notify_custom(connectionHandle, transferCharacteristicHandle, om);
+      SendReadData(connectionHandle, header->chunkoff, header->chunksize, fileSize);
       break;
     }
     case commands::WRITE: {
@@ -161,44 +145,49 @@ int FSService::FSCommandHandler(uint16_t connectionHandle, os_mbuf* om) {
       if (plen > maxpathlen) { //> counts for null term
         return -1;             // TODO make this actually return a BLE notif
       }
+      CloseTransferFile();
       memcpy(filepath, header->pathstr, plen);
       filepath[plen] = 0; // Copy and null terminate string
       fileSize = header->totalSize;
+      state = FSState::WRITE;
+      writeWindow = std::min(header->window, maxWriteWindow);
+      chunksSinceAck = 0;
+      resyncPending = false;
+      writeErrorSent = false;
       WriteResponse resp;
       resp.command = commands::WRITE_PACING;
+      resp.window = writeWindow;
       resp.offset = header->offset;
       resp.modTime = 0;
 
-      int res = fs.FileOpen(&f, filepath, LFS_O_RDWR | LFS_O_CREAT);
-      if (res == 0) {
-        fs.FileClose(&f);
-        resp.status = (res == 0) ? 0x01 : (int8_t) res;
+      const uint32_t offset = header->offset;
+      int res = OpenTransferFile(LFS_O_RDWR | LFS_O_CREAT);
+      // Resuming an upload: the data before the offset must already be in the file, the next chunk is written there
+      if (res == 0 && offset > 0) {
+        lfs_info info;
+        if (offset > header->totalSize || fs.Stat(filepath, &info) != 0 || offset > info.size) {
+          res = LFS_ERR_INVAL;
+        } else {
+          res = fs.FileSeek(&transferFile, offset);
+        }
+        if (res >= 0) {
+          filePosition = offset;
+          res = 0;
+        }
       }
-      resp.freespace = std::min(fs.getSize() - (fs.GetFSSize() * fs.getBlockSize()), fileSize - header->offset);
+      resp.status = (res == 0) ? 0x01 : (int8_t) res;
+      writeErrorSent = (res != 0);
+      if (res != 0 || offset >= header->totalSize) {
+        CloseTransferFile();
+      }
+      resp.freespace = std::min(fs.getSize() - (fs.GetFSSize() * fs.getBlockSize()), fileSize - std::min<uint32_t>(offset, fileSize));
       auto* om = ble_hs_mbuf_from_flat(&resp, sizeof(WriteResponse));
       ble_gattc_notify_custom(connectionHandle, transferCharacteristicHandle, om);
       break;
     }
     case commands::WRITE_DATA: {
       NRF_LOG_INFO("[FS_S] -> WriteData");
-      auto* header = (WritePacing*) om->om_data;
-      WriteResponse resp;
-      resp.command = commands::WRITE_PACING;
-      resp.offset = header->offset;
-      int res = 0;
-
-      if (!(res = fs.FileOpen(&f, filepath, LFS_O_RDWR | LFS_O_CREAT))) {
-        if ((res = fs.FileSeek(&f, header->offset)) >= 0) {
-          res = fs.FileWrite(&f, header->data, header->dataSize);
-        }
-        fs.FileClose(&f);
-      }
-      if (res < 0) {
-        resp.status = (int8_t) res;
-      }
-      resp.freespace = std::min(fs.getSize() - (fs.GetFSSize() * fs.getBlockSize()), fileSize - header->offset);
-      auto* om = ble_hs_mbuf_from_flat(&resp, sizeof(WriteResponse));
-      ble_gattc_notify_custom(connectionHandle, transferCharacteristicHandle, om);
+      WriteData(connectionHandle, (WritePacing*) om->om_data);
       break;
     }
     case commands::DELETE: {
@@ -316,29 +305,166 @@ int FSService::FSCommandHandler(uint16_t connectionHandle, os_mbuf* om) {
       break;
   }
   NRF_LOG_INFO("[FS_S] -> done ");
-  systemTask.PushMessage(Pinetime::System::Messages::StopFileTransfer);
   return 0;
 }
 
-// Loads resp with file data given a valid filepath header and resp
-void FSService::prepareReadDataResp(ReadHeader* header, ReadResponse* resp) {
-  // uint16_t plen = header->pathlen;
-  resp->command = commands::READ_DATA;
-  resp->chunkoff = header->chunkoff;
-  resp->status = 0x01;
-  struct lfs_info info = {};
-  int res = fs.Stat(filepath, &info);
-  if (res == LFS_ERR_NOENT && info.type != LFS_TYPE_DIR) {
-    resp->status = 0x03;
-    resp->chunklen = 0;
-    resp->totallen = 0;
+void FSService::WriteData(uint16_t connectionHandle, const WritePacing* header) {
+  // The file of a WRITE command stays open until it is complete or an error occurs. Chunks received after that
+  // (still in flight, or without WRITE command) are not written, reopening the file would write them past its end
+  // and littlefs would fill the gap with zeros. The error is answered once, the following chunks are dropped.
+  if (state != FSState::WRITE || !transferFileOpened) {
+    if (!writeErrorSent) {
+      writeErrorSent = true;
+      WriteResponse resp;
+      resp.command = commands::WRITE_PACING;
+      resp.status = (int8_t) LFS_ERR_BADF;
+      resp.window = writeWindow;
+      resp.offset = header->offset;
+      resp.modTime = 0;
+      resp.freespace = 0;
+      auto* om = ble_hs_mbuf_from_flat(&resp, sizeof(WriteResponse));
+      ble_gattc_notify_custom(connectionHandle, transferCharacteristicHandle, om);
+    }
+    return;
+  }
+
+  const bool windowed = writeWindow > 1;
+  int res = 0;
+  if (windowed && header->offset > filePosition) {
+    // A chunk is missing, the following ones are dropped and the data received so far is acknowledged once,
+    // the client sends the data again from there.
+    if (resyncPending) {
+      return;
+    }
+    resyncPending = true;
+    chunksSinceAck = writeWindow;
   } else {
-    lfs_file f;
-    resp->chunklen = std::min(header->chunksize, info.size);
-    resp->totallen = info.size;
-    fs.FileOpen(&f, filepath, LFS_O_RDONLY);
-    fs.FileSeek(&f, header->chunkoff);
-    resp->chunklen = fs.FileRead(&f, resp->chunk, resp->chunklen);
-    fs.FileClose(&f);
+    resyncPending = false;
+    if (header->offset != filePosition) {
+      res = fs.FileSeek(&transferFile, header->offset);
+    }
+    if (res >= 0) {
+      res = fs.FileWrite(&transferFile, header->data, header->dataSize);
+    }
+    if (res >= 0) {
+      filePosition = header->offset + res;
+    }
+    // The data is committed to the flash when the file is closed
+    if (res < 0 || filePosition >= static_cast<uint32_t>(fileSize)) {
+      CloseTransferFile();
+    }
+    chunksSinceAck++;
+  }
+
+  if (windowed && transferFileOpened && chunksSinceAck < writeWindow) {
+    return;
+  }
+  chunksSinceAck = 0;
+  writeErrorSent = (res < 0);
+
+  // Windowed writes acknowledge everything received up to the offset, others echo the offset of the chunk
+  WriteResponse resp;
+  resp.command = commands::WRITE_PACING;
+  resp.status = (res < 0) ? (int8_t) res : 0x01;
+  resp.window = writeWindow;
+  resp.offset = windowed ? filePosition : header->offset;
+  resp.modTime = 0;
+  resp.freespace = std::min(fs.getSize() - (fs.GetFSSize() * fs.getBlockSize()), fileSize - resp.offset);
+  auto* om = ble_hs_mbuf_from_flat(&resp, sizeof(WriteResponse));
+  ble_gattc_notify_custom(connectionHandle, transferCharacteristicHandle, om);
+}
+
+void FSService::OnDisconnect() {
+  CloseTransferFile();
+  state = FSState::IDLE;
+  StopSession();
+}
+
+void FSService::OnSessionTimeout() {
+  if (sessionActive.exchange(false)) {
+    systemTask.PushMessage(Pinetime::System::Messages::StopFileTransfer);
+  }
+}
+
+void FSService::StartSession() {
+  xTimerStop(sessionTimer, 0);
+  if (sessionActive.exchange(true)) {
+    return;
+  }
+  systemTask.PushMessage(Pinetime::System::Messages::StartFileTransfer);
+  vTaskDelay(10);
+  while (systemTask.IsSleeping()) {
+    vTaskDelay(100); // 50ms
+  }
+}
+
+void FSService::StopSession() {
+  xTimerStop(sessionTimer, 0);
+  OnSessionTimeout();
+}
+
+int FSService::OpenTransferFile(int flags) {
+  CloseTransferFile();
+  int res = fs.FileOpen(&transferFile, filepath, flags);
+  transferFileOpened = (res == 0);
+  filePosition = 0;
+  return res;
+}
+
+void FSService::CloseTransferFile() {
+  if (transferFileOpened) {
+    fs.FileClose(&transferFile);
+    transferFileOpened = false;
+  }
+}
+
+// Sends the chunk of the file at offset in a single READ_DATA notification: up to size bytes, as many as the MTU allows.
+// The data is read from the file directly into the buffer of the notification.
+void FSService::SendReadData(uint16_t connectionHandle, uint32_t offset, uint32_t size, uint32_t totalSize) {
+  const uint16_t mtu = ble_att_mtu(connectionHandle);
+  const uint32_t maxChunkSize = (mtu > 3 + sizeof(ReadResponse)) ? mtu - 3 - sizeof(ReadResponse) : 0;
+  const uint32_t end = std::min(offset + size, totalSize);
+
+  ReadResponse resp {};
+  resp.command = commands::READ_DATA;
+  resp.status = 0x01;
+  resp.chunkoff = offset;
+  resp.totallen = totalSize;
+  resp.chunklen = (offset < end) ? std::min(maxChunkSize, end - offset) : 0;
+  auto* om = ble_hs_mbuf_from_flat(&resp, sizeof(ReadResponse));
+  if (om == nullptr) {
+    NRF_LOG_INFO("[FS_S] -> No buffer for the chunk at %d", offset);
+    return;
+  }
+
+  if (resp.chunklen > 0) {
+    int res = (offset != filePosition) ? fs.FileSeek(&transferFile, offset) : 0;
+    auto* data = static_cast<uint8_t*>(os_mbuf_extend(om, resp.chunklen));
+    if (data == nullptr) {
+      res = LFS_ERR_NOMEM;
+    } else if (res >= 0) {
+      res = fs.FileRead(&transferFile, data, resp.chunklen);
+    }
+    const uint32_t read = (res > 0) ? res : 0;
+    if (data != nullptr && read < resp.chunklen) {
+      os_mbuf_adj(om, -static_cast<int>(resp.chunklen - read));
+    }
+    // On error, the client requests the chunk again
+    resp.status = (res < 0) ? (int8_t) res : 0x01;
+    resp.chunklen = read;
+    os_mbuf_copyinto(om, offsetof(ReadResponse, status), &resp.status, sizeof(resp.status));
+    os_mbuf_copyinto(om, offsetof(ReadResponse, chunklen), &resp.chunklen, sizeof(resp.chunklen));
+    offset += read;
+    // The position in the file isn't known after an error, the next chunk seeks
+    filePosition = (res >= 0) ? offset : std::numeric_limits<uint32_t>::max();
+  }
+
+  // The notification can't be queued when the stack runs out of buffers, the client requests the chunk again
+  if (ble_gattc_notify_custom(connectionHandle, transferCharacteristicHandle, om) != 0) {
+    NRF_LOG_INFO("[FS_S] -> Chunk at %d not sent", resp.chunkoff);
+  }
+
+  if (offset >= totalSize) {
+    CloseTransferFile();
   }
 }
@@ -1,4 +1,7 @@
 #pragma once
+#include <atomic>
+#include <FreeRTOS.h>
+#include <timers.h>
 #define min // workaround: nimble's min/max macros conflict with libstdc++
 #define max
 #include <host/ble_gap.h>
@@ -24,6 +27,8 @@ namespace Pinetime {
 
       int OnFSServiceRequested(uint16_t connectionHandle, uint16_t attributeHandle, ble_gatt_access_ctxt* context);
       void NotifyFSRaw(uint16_t connectionHandle);
+      void OnDisconnect();
+      void OnSessionTimeout();
 
     private:
       Pinetime::System::SystemTask& systemTask;
@@ -35,7 +40,7 @@ namespace Pinetime {
       static constexpr uint16_t FSServiceId {0xFEBB};
       static constexpr uint16_t fsVersionId {0x0100};
       static constexpr uint16_t fsTransferId {0x0200};
-      uint16_t fsVersion = {0x0004};
+      uint16_t fsVersion = {0x0005};
       static constexpr uint16_t maxpathlen = 256;
       static constexpr ble_uuid16_t fsServiceUuid {
         .u {.type = BLE_UUID_TYPE_16},
@@ -80,6 +85,27 @@ namespace Pinetime {
       char filepath[maxpathlen]; // TODO ..ugh fixed filepath len
       int fileSize;
 
+      // The file being read or written stays open between the chunks of a transfer.
+      // filePosition is the position in the file after the last chunk, to seek only when the client skips data.
+      lfs_file_t transferFile;
+      bool transferFileOpened = false;
+      uint32_t filePosition = 0;
+
+      // The watch is kept awake by a single wake lock for all the commands of a session, which ends
+      // after sessionTimeout without command or on disconnection.
+      static constexpr TickType_t sessionTimeout = pdMS_TO_TICKS(5000);
+      TimerHandle_t sessionTimer;
+      std::atomic<bool> sessionActive {false};
+
+      // Windowed writes: the client sends up to writeWindow chunks before waiting for a WRITE_PACING,
+      // which acknowledges all the data received so far.
+      static constexpr uint8_t maxWriteWindow = 8;
+      uint8_t writeWindow = 0;
+      uint8_t chunksSinceAck = 0;
+      bool resyncPending = false;
+      // The error that ended the current WRITE session was answered, the chunks still in flight are dropped
+      bool writeErrorSent = false;
+
       using ReadHeader = struct __attribute__((packed)) {
         commands command;
         uint8_t padding;
@@ -109,7 +135,7 @@ namespace Pinetime {
 
       using WriteHeader = struct __attribute__((packed)) {
         commands command;
-        uint8_t padding;
+        uint8_t window;
         uint16_t pathlen;
         uint32_t offset;
         uint64_t modTime;
@@ -120,7 +146,7 @@ namespace Pinetime {
       using WriteResponse = struct __attribute__((packed)) {
         commands command;
         uint8_t status;
-        uint16_t padding;
+        uint16_t window;
         uint32_t offset;
         uint64_t modTime;
         uint32_t freespace;
@@ -197,7 +223,12 @@ namespace Pinetime {
       };
 
       int FSCommandHandler(uint16_t connectionHandle, os_mbuf* om);
-      void prepareReadDataResp(ReadHeader* header, ReadResponse* resp);
+      void StartSession();
+      void StopSession();
+      void WriteData(uint16_t connectionHandle, const WritePacing* header);
+      int OpenTransferFile(int flags);
+      void CloseTransferFile();
+      void SendReadData(uint16_t connectionHandle, uint32_t offset, uint32_t size, uint32_t totalSize);
     };
   }
 }
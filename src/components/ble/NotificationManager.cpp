@@ -20,6 +20,7 @@ void NotificationManager::Push(NotificationManager::Notification&& notif) {
   if (size < notifications.size()) {
     size++;
   }
+  changeNotifier.Notify(ChangeNotifier::Topics::Notifications);
 }
 
 NotificationManager::Notification::Id NotificationManager::GetNextId() {
@@ -110,6 +111,7 @@ void NotificationManager::DismissIdx(NotificationManager::Notification::Idx idx)
     this->At(size - 1).valid = false;
   }
   --size;
+  changeNotifier.Notify(ChangeNotifier::Topics::Notifications);
 }
 
 void NotificationManager::Dismiss(NotificationManager::Notification::Id id) {
@@ -125,7 +127,11 @@ bool NotificationManager::AreNewNotificationsAvailable() const {
 }
 
 bool NotificationManager::ClearNewNotificationFlag() {
-  return newNotification.exchange(false);
+  const bool cleared = newNotification.exchange(false);
+  if (cleared) {
+    changeNotifier.Notify(ChangeNotifier::Topics::Notifications);
+  }
+  return cleared;
 }
 
 size_t NotificationManager::NbNotifications() const {
@@ -4,6 +4,7 @@
 #include <atomic>
 #include <cstddef>
 #include <cstdint>
+#include "components/changenotifier/ChangeNotifier.h"
 
 namespace Pinetime {
   namespace Controllers {
@@ -24,6 +25,9 @@ namespace Pinetime {
       };
       static constexpr uint8_t MessageSize {100};
 
+      explicit NotificationManager(ChangeNotifier& changeNotifier) : changeNotifier {changeNotifier} {
+      }
+
       struct Notification {
         using Id = uint8_t;
         using Idx = uint8_t;
@@ -60,6 +64,7 @@ namespace Pinetime {
       size_t NbNotifications() const;
 
     private:
+      ChangeNotifier& changeNotifier;
       Notification::Id nextId {0};
       Notification::Id GetNextId();
       const Notification& At(Notification::Idx idx) const;
@@ -116,7 +116,8 @@ int WeatherCallback(uint16_t /*connHandle*/, uint16_t /*attrHandle*/, struct ble
   return static_cast<Pinetime::Controllers::SimpleWeatherService*>(arg)->OnCommand(ctxt);
 }
 
-SimpleWeatherService::SimpleWeatherService(DateTime& dateTimeController) : dateTimeController(dateTimeController) {
+SimpleWeatherService::SimpleWeatherService(DateTime& dateTimeController, ChangeNotifier& changeNotifier)
+  : dateTimeController(dateTimeController), changeNotifier(changeNotifier) {
 }
 
 void SimpleWeatherService::Init() {
@@ -142,6 +143,7 @@ int SimpleWeatherService::OnCommand(struct ble_gatt_access_ctxt* ctxt) {
         if (GetVersion(dataBuffer) == 1) {
           NRF_LOG_INFO("Sunrise: %d\n\tSunset: %d", currentWeather->sunrise, currentWeather->sunset);
         }
+        changeNotifier.Notify(ChangeNotifier::Topics::Weather);
       }
       break;
     case MessageType::Forecast:
@@ -155,6 +157,7 @@ int SimpleWeatherService::OnCommand(struct ble_gatt_access_ctxt* ctxt) {
                        forecast->days[i]->maxTemperature.PreciseCelsius(),
                        forecast->days[i]->iconId);
         }
+        changeNotifier.Notify(ChangeNotifier::Topics::Weather);
       }
       break;
     default:
@@ -31,6 +31,7 @@
 #undef max
 #undef min
 
+#include "components/changenotifier/ChangeNotifier.h"
 #include "components/datetime/DateTimeController.h"
 #include <lvgl/lvgl.h>
 #include "displayapp/InfiniTimeTheme.h"
@@ -43,7 +44,7 @@ namespace Pinetime {
 
     class SimpleWeatherService {
     public:
-      explicit SimpleWeatherService(DateTime& dateTimeController);
+      SimpleWeatherService(DateTime& dateTimeController, ChangeNotifier& changeNotifier);
 
       void Init();
 
@@ -189,6 +190,7 @@ namespace Pinetime {
       uint16_t eventHandle {};
 
       Pinetime::Controllers::DateTime& dateTimeController;
+      ChangeNotifier& changeNotifier;
 
       std::optional<CurrentWeather> currentWeather;
       std::optional<Forecast> forecast;
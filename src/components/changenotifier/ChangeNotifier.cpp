@@ -0,0 +1,33 @@
+#include "components/changenotifier/ChangeNotifier.h"
+#ifdef PINETIME_IS_RECOVERY
+  #include "displayapp/DisplayAppRecovery.h"
+#else
+  #include "displayapp/DisplayApp.h"
+#endif
+
+using namespace Pinetime::Controllers;
+
+void ChangeNotifier::Register(Applications::DisplayApp* displayApp) {
+  this->displayApp = displayApp;
+}
+
+void ChangeNotifier::Notify(Topics topic) {
+  const TopicMask mask = Mask(topic);
+  if ((subscriptions & mask) == 0) {
+    return;
+  }
+
+  // Only the first change since DisplayApp took the pending topics wakes it up
+  if (pending.fetch_or(mask) == 0 && displayApp != nullptr) {
+    displayApp->PushMessage(Applications::Display::Messages::StateChanged);
+  }
+}
+
+void ChangeNotifier::Subscribe(TopicMask topics) {
+  subscriptions = topics;
+  pending &= topics;
+}
+
+ChangeNotifier::TopicMask ChangeNotifier::TakePending() {
+  return pending.exchange(0) & subscriptions;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace Pinetime {
+  namespace Applications {
+    class DisplayApp;
+  }
+
+  namespace Controllers {
+    // Controllers notify the values they changed, so that screens are refreshed when something they show changed
+    // instead of polling every controller in a refresh task.
+    // Notify() can be called from any task or interrupt, DisplayApp is only woken up for the topics the current
+    // screen subscribed to.
+    class ChangeNotifier {
+    public:
+      enum class Topics : uint8_t { Time, Battery, Ble, HeartRate, Motion, Notifications, Weather, Alarm };
+      using TopicMask = uint32_t;
+
+      static constexpr TopicMask Mask(Topics topic) {
+        return 1U << static_cast<uint8_t>(topic);
+      }
+
+      void Register(Applications::DisplayApp* displayApp);
+
+      void Notify(Topics topic);
+
+      void Subscribe(TopicMask topics);
+
+      TopicMask Subscriptions() const {
+        return subscriptions;
+      }
+
+      // Returns the subscribed topics that changed since the last call
+      TopicMask TakePending();
+
+    private:
+      Applications::DisplayApp* displayApp = nullptr;
+      std::atomic<TopicMask> subscriptions {0};
+      std::atomic<TopicMask> pending {0};
+    };
+  }
+}
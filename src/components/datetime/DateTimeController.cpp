@@ -25,7 +25,8 @@ namespace {
   }
 }
 
-DateTime::DateTime(Controllers::Settings& settingsController) : settingsController {settingsController} {
+DateTime::DateTime(Controllers::Settings& settingsController, ChangeNotifier& changeNotifier)
+  : settingsController {settingsController}, changeNotifier {changeNotifier} {
   mutex = xSemaphoreCreateMutex();
   ASSERT(mutex != nullptr);
   xSemaphoreGive(mutex);
@@ -64,11 +65,13 @@ void DateTime::SetTime(uint16_t year, uint8_t month, uint8_t day, uint8_t hour,
   if (systemTask != nullptr) {
     systemTask->PushMessage(System::Messages::OnNewTime);
   }
+  changeNotifier.Notify(ChangeNotifier::Topics::Time);
 }
 
 void DateTime::SetTimeZone(int8_t timezone, int8_t dst) {
   tzOffset = timezone;
   dstOffset = dst;
+  changeNotifier.Notify(ChangeNotifier::Topics::Time);
 }
 
 std::chrono::time_point<std::chrono::system_clock, std::chrono::nanoseconds> DateTime::CurrentDateTime() {
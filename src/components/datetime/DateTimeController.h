@@ -5,6 +5,7 @@
 #include <ctime>
 #include <string>
 #include "components/settings/Settings.h"
+#include "components/changenotifier/ChangeNotifier.h"
 #include <FreeRTOS.h>
 #include <semphr.h>
 
@@ -16,7 +17,7 @@ namespace Pinetime {
   namespace Controllers {
     class DateTime {
     public:
-      DateTime(Controllers::Settings& settingsController);
+      DateTime(Controllers::Settings& settingsController, ChangeNotifier& changeNotifier);
       enum class Days : uint8_t { Unknown, Monday, Tuesday, Wednesday, Thursday, Friday, Saturday, Sunday };
       enum class Months : uint8_t {
         Unknown,
@@ -158,6 +159,7 @@ namespace Pinetime {
       bool isHalfHourAlreadyNotified = true;
       System::SystemTask* systemTask = nullptr;
       Controllers::Settings& settingsController;
+      ChangeNotifier& changeNotifier;
     };
   }
 }
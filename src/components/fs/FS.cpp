@@ -1,4 +1,5 @@
 #include "components/fs/FS.h"
+#include <algorithm>
 #include <cstring>
 #include <littlefs/lfs.h>
 #include <lvgl/lvgl.h>
@@ -14,14 +15,14 @@ FS::FS(Pinetime::Drivers::SpiNorFlash& driver)
       .erase = SectorErase,
       .sync = SectorSync,
 
-      .read_size = 16,
-      .prog_size = 8,
+      .read_size = readSize,
+      .prog_size = progSize,
       .block_size = blockSize,
       .block_count = size / blockSize,
       .block_cycles = 1000u,
 
-      .cache_size = 16,
-      .lookahead_size = 16,
+      .cache_size = cacheSize,
+      .lookahead_size = lookaheadSize,
 
       .name_max = 50,
       .attr_max = 50,
@@ -54,14 +55,37 @@ void FS::VerifyResource() {
 }
 
 int FS::FileOpen(lfs_file_t* file_p, const char* fileName, const int flags) {
+  if ((flags & LFS_O_WRONLY) != 0 && std::strcmp(fileName, ResourceBundle::path) == 0) {
+    resources.Invalidate();
+    resourcesWriter = file_p;
+  }
+  if (readAhead.file == file_p) {
+    readAhead.file = nullptr;
+  }
   return lfs_file_open(&lfs, file_p, fileName, flags);
 }
 
 int FS::FileClose(lfs_file_t* file_p) {
-  return lfs_file_close(&lfs, file_p);
+  if (readAhead.file == file_p) {
+    readAhead.file = nullptr;
+  }
+  const int result = lfs_file_close(&lfs, file_p);
+  // The bundle may have been loaded while it was written, reload it now that it is complete
+  if (file_p == resourcesWriter) {
+    resources.Invalidate();
+    resourcesWriter = nullptr;
+  }
+  return result;
 }
 
 int FS::FileRead(lfs_file_t* file_p, uint8_t* buff, uint32_t size) {
+  const bool readOnly = (file_p->flags & LFS_O_WRONLY) == 0;
+  if (readOnly && size < readAheadBuffer.size()) {
+    return ReadAheadRead(file_p, buff, size);
+  }
+  if (readAhead.file == file_p) {
+    ReleaseReadAhead();
+  }
   return lfs_file_read(&lfs, file_p, buff, size);
 }
 
@@ -70,10 +94,63 @@ int FS::FileWrite(lfs_file_t* file_p, const uint8_t* buff, uint32_t size) {
 }
 
 int FS::FileSeek(lfs_file_t* file_p, uint32_t pos) {
+  if (readAhead.file == file_p) {
+    if (pos >= readAhead.start && pos <= readAhead.start + readAhead.length) {
+      readAhead.position = pos;
+      return pos;
+    }
+    readAhead.file = nullptr;
+  }
   return lfs_file_seek(&lfs, file_p, pos, LFS_SEEK_SET);
 }
 
+int FS::ReadAheadRead(lfs_file_t* file_p, uint8_t* buff, uint32_t size) {
+  if (readAhead.file != file_p) {
+    ReleaseReadAhead();
+    const lfs_soff_t position = lfs_file_tell(&lfs, file_p);
+    if (position < 0) {
+      return position;
+    }
+    readAhead = {file_p, static_cast<uint32_t>(position), 0, static_cast<uint32_t>(position)};
+  } else if (readAhead.position + size <= readAhead.start + readAhead.length) {
+    statistics.readAheadHits++;
+  }
+
+  uint32_t copied = 0;
+  while (copied < size) {
+    const uint32_t available = readAhead.start + readAhead.length - readAhead.position;
+    if (available == 0) {
+      const int result = lfs_file_read(&lfs, file_p, readAheadBuffer.data(), readAheadBuffer.size());
+      if (result < 0) {
+        readAhead.file = nullptr;
+        return result;
+      }
+      readAhead.start = readAhead.position;
+      readAhead.length = result;
+      if (result == 0) {
+        break;
+      }
+      continue;
+    }
+
+    const uint32_t count = std::min(available, size - copied);
+    std::memcpy(buff + copied, &readAheadBuffer[readAhead.position - readAhead.start], count);
+    readAhead.position += count;
+    copied += count;
+  }
+  return copied;
+}
+
+void FS::ReleaseReadAhead() {
+  // Move the littlefs file back to the position its user expects
+  if (readAhead.file != nullptr && readAhead.position != readAhead.start + readAhead.length) {
+    lfs_file_seek(&lfs, readAhead.file, readAhead.position, LFS_SEEK_SET);
+  }
+  readAhead.file = nullptr;
+}
+
 int FS::FileDelete(const char* fileName) {
+  InvalidateResources(fileName);
   return lfs_remove(&lfs, fileName);
 }
 
@@ -98,6 +175,8 @@ int FS::DirCreate(const char* path) {
 }
 
 int FS::Rename(const char* oldPath, const char* newPath) {
+  InvalidateResources(oldPath);
+  InvalidateResources(newPath);
   return lfs_rename(&lfs, oldPath, newPath);
 }
 
@@ -105,6 +184,18 @@ int FS::Stat(const char* path, lfs_info* info) {
   return lfs_stat(&lfs, path, info);
 }
 
+bool FS::ResourceExists(const char* path) {
+  ResourceBundle::Resource resource;
+  lfs_info info;
+  return resources.Find(path, resource) || lfs_stat(&lfs, path, &info) == LFS_ERR_OK;
+}
+
+void FS::InvalidateResources(const char* path) {
+  if (std::strcmp(path, ResourceBundle::path) == 0) {
+    resources.Invalidate();
+  }
+}
+
 lfs_ssize_t FS::GetFSSize() {
   return lfs_fs_size(&lfs);
 }
@@ -121,6 +212,7 @@ int FS::SectorSync(const struct lfs_config* /*c*/) {
 int FS::SectorErase(const struct lfs_config* c, lfs_block_t block) {
   Pinetime::Controllers::FS& lfs = *(static_cast<Pinetime::Controllers::FS*>(c->context));
   const size_t address = startAddress + (block * blockSize);
+  lfs.statistics.erases++;
   lfs.flashDriver.SectorErase(address);
   return lfs.flashDriver.EraseFailed() ? -1 : 0;
 }
@@ -128,6 +220,8 @@ int FS::SectorErase(const struct lfs_config* c, lfs_block_t block) {
 int FS::SectorProg(const struct lfs_config* c, lfs_block_t block, lfs_off_t off, const void* buffer, lfs_size_t size) {
   Pinetime::Controllers::FS& lfs = *(static_cast<Pinetime::Controllers::FS*>(c->context));
   const size_t address = startAddress + (block * blockSize) + off;
+  lfs.statistics.progs++;
+  lfs.statistics.progBytes += size;
   lfs.flashDriver.Write(address, (uint8_t*) buffer, size);
   return lfs.flashDriver.ProgramFailed() ? -1 : 0;
 }
@@ -135,6 +229,8 @@ int FS::SectorProg(const struct lfs_config* c, lfs_block_t block, lfs_off_t off,
 int FS::SectorRead(const struct lfs_config* c, lfs_block_t block, lfs_off_t off, void* buffer, lfs_size_t size) {
   Pinetime::Controllers::FS& lfs = *(static_cast<Pinetime::Controllers::FS*>(c->context));
   const size_t address = startAddress + (block * blockSize) + off;
+  lfs.statistics.reads++;
+  lfs.statistics.readBytes += size;
   lfs.flashDriver.Read(address, static_cast<uint8_t*>(buffer), size);
   return 0;
 }
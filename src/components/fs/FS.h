@@ -1,13 +1,26 @@
 #pragma once
 
+#include <array>
 #include <cstdint>
 #include "drivers/SpiNorFlash.h"
+#include "components/fs/ResourceBundle.h"
 #include <littlefs/lfs.h>
 
 namespace Pinetime {
   namespace Controllers {
     class FS {
     public:
+      // Accesses to the SPI flash made by littlefs
+      struct Statistics {
+        uint32_t reads = 0;
+        uint32_t readBytes = 0;
+        uint32_t progs = 0;
+        uint32_t progBytes = 0;
+        uint32_t erases = 0;
+        // Calls to FileRead() served from the read-ahead buffer
+        uint32_t readAheadHits = 0;
+      };
+
       FS(Pinetime::Drivers::SpiNorFlash&);
 
       void Init();
@@ -29,8 +42,14 @@ namespace Pinetime {
       lfs_ssize_t GetFSSize();
       int Rename(const char* oldPath, const char* newPath);
       int Stat(const char* path, lfs_info* info);
+      // Returns true if the resource installed at path ("/fonts/teko.bin") is in the bundle or in its own file
+      bool ResourceExists(const char* path);
       void VerifyResource();
 
+      ResourceBundle& Resources() {
+        return resources;
+      }
+
       static size_t getSize() {
         return size;
       }
@@ -39,6 +58,10 @@ namespace Pinetime {
         return blockSize;
       }
 
+      const Statistics& GetStatistics() const {
+        return statistics;
+      }
+
     private:
       Pinetime::Drivers::SpiNorFlash& flashDriver;
 
@@ -68,10 +91,44 @@ namespace Pinetime {
       static constexpr size_t size = 0x34C000;
       static constexpr size_t blockSize = 4096;
 
+      static constexpr size_t readSize = 16;
+      static constexpr size_t progSize = 8;
+      // Size of the read and program caches of littlefs, and of the cache of each open file.
+      // Reads smaller than the cache are rounded up to it, so it sets the minimum size of the SPI transfers.
+      // It must not be smaller than 16 (its original value), or the inline files written with it can't be read back.
+      static constexpr size_t cacheSize = 128;
+      // Size of the bitmap of free blocks, in bytes. Each byte covers 8 blocks.
+      static constexpr size_t lookaheadSize = 64;
+      // Small sequential reads of files opened read-only are served from a buffer of this size
+      static constexpr size_t readAheadSize = 256;
+
+      static_assert(cacheSize >= 16 && cacheSize % readSize == 0 && cacheSize % progSize == 0 && blockSize % cacheSize == 0,
+                    "littlefs requires the cache size to be a multiple of the read and program sizes and a factor of the block size");
+      static_assert(lookaheadSize % 8 == 0, "littlefs requires the lookahead size to be a multiple of 8");
+
       bool resourcesValid = false;
       const struct lfs_config lfsConfig;
 
       lfs_t lfs;
+      ResourceBundle resources {*this};
+      // The bundle file while it is open for writing, the bundle is reloaded again once it is closed
+      lfs_file_t* resourcesWriter = nullptr;
+
+      // The read-ahead buffer holds data of one file at a time. Its position in the littlefs file is the end of
+      // the buffer, and position is the position seen by the user of the file.
+      struct ReadAhead {
+        lfs_file_t* file = nullptr;
+        uint32_t start = 0;
+        uint32_t length = 0;
+        uint32_t position = 0;
+      };
+      ReadAhead readAhead;
+      std::array<uint8_t, readAheadSize> readAheadBuffer;
+      Statistics statistics;
+
+      void InvalidateResources(const char* path);
+      int ReadAheadRead(lfs_file_t* file_p, uint8_t* buff, uint32_t size);
+      void ReleaseReadAhead();
 
       static int SectorSync(const struct lfs_config* c);
       static int SectorErase(const struct lfs_config* c, lfs_block_t block);
@@ -0,0 +1,93 @@
+#include "components/fs/ResourceBundle.h"
+
+#include <cstring>
+#include <FreeRTOS.h>
+#include <libraries/log/nrf_log.h>
+#include "components/fs/FS.h"
+
+using namespace Pinetime::Controllers;
+
+namespace {
+  struct Header {
+    char magic[4];
+    uint16_t version;
+    uint16_t count;
+  };
+
+  constexpr char magic[4] = {'I', 'R', 'E', 'S'};
+}
+
+ResourceBundle::ResourceBundle(FS& filesystem) : filesystem {filesystem} {
+}
+
+bool ResourceBundle::Find(const char* resourcePath, Resource& resource) {
+  if (invalid) {
+    Open();
+  }
+
+  int32_t low = 0;
+  int32_t high = static_cast<int32_t>(entriesCount) - 1;
+  while (low <= high) {
+    const int32_t middle = (low + high) / 2;
+    const int comparison = std::strncmp(entries[middle].path, resourcePath, maxPathLength);
+    if (comparison < 0) {
+      low = middle + 1;
+    } else if (comparison > 0) {
+      high = middle - 1;
+    } else {
+      resource.offset = entries[middle].offset;
+      resource.size = entries[middle].size;
+      resource.compressedSize = entries[middle].compressedSize;
+      return true;
+    }
+  }
+  return false;
+}
+
+int ResourceBundle::Read(uint32_t offset, uint8_t* buffer, uint32_t size) {
+  if (!opened) {
+    return LFS_ERR_NOENT;
+  }
+  const int result = filesystem.FileSeek(&file, offset);
+  if (result < 0) {
+    return result;
+  }
+  return filesystem.FileRead(&file, buffer, size);
+}
+
+void ResourceBundle::Open() {
+  Close();
+  invalid = false;
+
+  if (filesystem.FileOpen(&file, path, LFS_O_RDONLY) != LFS_ERR_OK) {
+    return;
+  }
+  opened = true;
+
+  Header header;
+  if (filesystem.FileRead(&file, reinterpret_cast<uint8_t*>(&header), sizeof(header)) != sizeof(header) ||
+      std::memcmp(header.magic, magic, sizeof(magic)) != 0 || header.version != version) {
+    NRF_LOG_INFO("[ResourceBundle] Invalid header");
+    Close();
+    return;
+  }
+
+  const uint32_t indexSize = header.count * sizeof(Entry);
+  entries = static_cast<Entry*>(pvPortMalloc(indexSize));
+  if (entries == nullptr || filesystem.FileRead(&file, reinterpret_cast<uint8_t*>(entries), indexSize) != static_cast<int>(indexSize)) {
+    Close();
+    return;
+  }
+  entriesCount = header.count;
+  NRF_LOG_INFO("[ResourceBundle] %d resources", entriesCount);
+}
+
+void ResourceBundle::Close() {
+  vPortFree(entries);
+  entries = nullptr;
+  entriesCount = 0;
+  if (opened) {
+    filesystem.FileClose(&file);
+    opened = false;
+  }
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <littlefs/lfs.h>
+
+namespace Pinetime {
+  namespace Controllers {
+    class FS;
+
+    // Read-only pack of the fonts and images of the resource package, built by generate-package.py and
+    // installed as a single file (path). The file starts with a header and an index sorted by path:
+    //
+    //   header : magic "IRES", version (u16), number of resources (u16)
+    //   index  : path (32 bytes, NUL padded), offset of the data in the file (u32), size (u32),
+    //            compressed size (u32, 0 if the resource is stored uncompressed)
+    //   data   : the resources, 4 bytes aligned
+    //
+    // Compressed resources are in the heatshrink format (see components/heatshrink/HeatshrinkDecoder.h).
+    //
+    // The index is loaded in RAM and the file is kept open, so finding a resource is a binary search and
+    // reading it a single seek in the file, instead of a directory walk for each file opened.
+    class ResourceBundle {
+    public:
+      struct Resource {
+        uint32_t offset;
+        // Size of the uncompressed resource
+        uint32_t size;
+        uint32_t compressedSize;
+      };
+
+      explicit ResourceBundle(FS& filesystem);
+
+      ResourceBundle(const ResourceBundle&) = delete;
+      ResourceBundle& operator=(const ResourceBundle&) = delete;
+      ResourceBundle(ResourceBundle&&) = delete;
+      ResourceBundle& operator=(ResourceBundle&&) = delete;
+
+      // Looks up the resource installed at path ("/fonts/teko.bin").
+      // Returns false if there is no bundle or it doesn't contain the resource.
+      bool Find(const char* path, Resource& resource);
+
+      // Reads size bytes at offset in the bundle, returns the number of bytes read or a negative littlefs error
+      int Read(uint32_t offset, uint8_t* buffer, uint32_t size);
+
+      // Called when the bundle file is modified, it is reopened on the next lookup. Can be called from any task.
+      void Invalidate() {
+        generation++;
+        invalid = true;
+      }
+
+      // Changes every time the bundle is invalidated, the resources found before may have moved
+      uint32_t Generation() const {
+        return generation;
+      }
+
+      static constexpr const char* path = "/resources.pak";
+      static constexpr size_t maxPathLength = 32;
+
+    private:
+      struct Entry {
+        char path[maxPathLength];
+        uint32_t offset;
+        uint32_t size;
+        uint32_t compressedSize;
+      };
+
+      static constexpr uint16_t version = 2;
+
+      void Open();
+      void Close();
+
+      FS& filesystem;
+      lfs_file_t file;
+      bool opened = false;
+      Entry* entries = nullptr;
+      uint16_t entriesCount = 0;
+      std::atomic<bool> invalid {true};
+      std::atomic<uint32_t> generation {0};
+    };
+  }
+}
@@ -5,16 +5,21 @@
 using namespace Pinetime::Controllers;
 
 void HeartRateController::Update(HeartRateController::States newState, uint8_t heartRate) {
+  const bool stateChanged = this->state != newState;
   this->state = newState;
   if (this->heartRate != heartRate) {
     this->heartRate = heartRate;
     service->OnNewHeartRateValue(heartRate);
+    changeNotifier.Notify(ChangeNotifier::Topics::HeartRate);
+  } else if (stateChanged) {
+    changeNotifier.Notify(ChangeNotifier::Topics::HeartRate);
   }
 }
 
 void HeartRateController::Enable() {
   if (task != nullptr) {
     state = States::NotEnoughData;
+    changeNotifier.Notify(ChangeNotifier::Topics::HeartRate);
     task->PushMessage(Pinetime::Applications::HeartRateTask::Messages::Enable);
   }
 }
@@ -22,6 +27,7 @@ void HeartRateController::Enable() {
 void HeartRateController::Disable() {
   if (task != nullptr) {
     state = States::Stopped;
+    changeNotifier.Notify(ChangeNotifier::Topics::HeartRate);
     task->PushMessage(Pinetime::Applications::HeartRateTask::Messages::Disable);
   }
 }
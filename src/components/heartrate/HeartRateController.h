@@ -2,6 +2,7 @@
 
 #include <cstdint>
 #include <components/ble/HeartRateService.h>
+#include "components/changenotifier/ChangeNotifier.h"
 
 namespace Pinetime {
   namespace Applications {
@@ -17,7 +18,9 @@ namespace Pinetime {
     public:
       enum class States : uint8_t { Stopped, NotEnoughData, NoTouch, Running };
 
-      HeartRateController() = default;
+      explicit HeartRateController(ChangeNotifier& changeNotifier) : changeNotifier {changeNotifier} {
+      }
+
       void Enable();
       void Disable();
       void Update(States newState, uint8_t heartRate);
@@ -35,6 +38,7 @@ namespace Pinetime {
       void SetService(Pinetime::Controllers::HeartRateService* service);
 
     private:
+      ChangeNotifier& changeNotifier;
       Applications::HeartRateTask* task = nullptr;
       States state = States::Stopped;
       uint8_t heartRate = 0;
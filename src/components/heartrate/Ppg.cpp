@@ -1,56 +1,62 @@
 #include "components/heartrate/Ppg.h"
+#include <algorithm>
+#include <cmath>
 #include <nrf_log.h>
 #include <vector>
+#include "utility/CycleCounter.h"
 
 using namespace Pinetime::Controllers;
 
 namespace {
-  float LinearInterpolation(const float* xValues, const float* yValues, int length, float pointX) {
-    if (pointX > xValues[length - 1]) {
-      return yValues[length - 1];
-    } else if (pointX <= xValues[0]) {
-      return yValues[0];
+  // Position of the threshold crossing between the bins index and index + 1, from the parabola through the
+  // bins around peakIndex, the end of the segment above the threshold. Falls back to a linear interpolation
+  // between the two bins when the parabola doesn't cross the threshold in the segment.
+  float ThresholdCrossing(const float* values, int length, int index, int peakIndex, float threshold) {
+    const float linear = static_cast<float>(index) + (threshold - values[index]) / (values[index + 1] - values[index]);
+    if (peakIndex < 1 || peakIndex >= length - 1) {
+      return linear;
     }
-    int index = 0;
-    while (pointX > xValues[index] && index < length - 1) {
-      index++;
+    // values[peakIndex + t] ~= a * t^2 + b * t + c + threshold
+    const float a = (values[peakIndex + 1] + values[peakIndex - 1]) / 2.0f - values[peakIndex];
+    const float b = (values[peakIndex + 1] - values[peakIndex - 1]) / 2.0f;
+    const float c = values[peakIndex] - threshold;
+    const float discriminant = b * b - 4.0f * a * c;
+    if (discriminant < 0.0f) {
+      return linear;
     }
-    float pointX0 = xValues[index - 1];
-    float pointX1 = xValues[index];
-    float pointY0 = yValues[index - 1];
-    float pointY1 = yValues[index];
-    float mu = (pointX - pointX0) / (pointX1 - pointX0);
-
-    return (pointY0 * (1 - mu) + pointY1 * mu);
+    // Numerically stable roots q / a and c / q
+    const float q = -0.5f * (b + std::copysign(sqrtf(discriminant), b));
+    const float low = static_cast<float>(index - peakIndex);
+    const float high = low + 1.0f;
+    if (a != 0.0f && q / a >= low && q / a <= high) {
+      return static_cast<float>(peakIndex) + q / a;
+    }
+    if (q != 0.0f && c / q >= low && c / q <= high) {
+      return static_cast<float>(peakIndex) + c / q;
+    }
+    return linear;
   }
 
-  float PeakSearch(float* xVals, float* yVals, float threshold, float& width, float start, float end, int length) {
+  // Returns the center (bins) of the peak of values above threshold between the bins start and end, and its
+  // width at threshold, or 0 if there is no peak or more than one. The peak must rise above the threshold
+  // after start and fall below it before end.
+  float PeakSearch(const float* values, int length, float threshold, float& width, int start, int end) {
     int peaks = 0;
     bool enabled = false;
     float minBin = 0.0f;
-    float maxBin = 0.0f;
     float peakCenter = 0.0f;
-    float prevValue = LinearInterpolation(xVals, yVals, length, start - 0.01f);
-    float currValue = LinearInterpolation(xVals, yVals, length, start);
-    float idx = start;
-    while (idx < end) {
-      float nextValue = LinearInterpolation(xVals, yVals, length, idx + 0.01f);
-      if (currValue < threshold) {
+    for (int idx = start; idx < end && idx < length - 1; idx++) {
+      if (values[idx] < threshold) {
         enabled = true;
-      }
-      if (currValue >= threshold and enabled) {
-        if (prevValue < threshold) {
-          minBin = idx;
-        } else if (nextValue <= threshold) {
-          maxBin = idx;
-          peaks++;
-          width = maxBin - minBin;
-          peakCenter = width / 2.0f + minBin;
+        if (values[idx + 1] >= threshold) {
+          minBin = ThresholdCrossing(values, length, idx, idx + 1, threshold);
         }
+      } else if (enabled && values[idx + 1] < threshold) {
+        const float maxBin = ThresholdCrossing(values, length, idx, idx, threshold);
+        peaks++;
+        width = maxBin - minBin;
+        peakCenter = width / 2.0f + minBin;
       }
-      prevValue = currValue;
-      currValue = nextValue;
-      idx += 0.01f;
     }
     if (peaks != 1) {
       width = 0.0f;
@@ -77,32 +83,6 @@ namespace {
     return max / mean;
   }
 
-  // Simple bandpass filter using exponential moving average
-  void Filter30to240(std::array<float, Ppg::dataLength>& signal) {
-    // From:
-    // https://www.norwegiancreations.com/2016/03/arduino-tutorial-simple-high-pass-band-pass-and-band-stop-filtering/
-
-    int length = signal.size();
-    // 0.268 is ~0.5Hz and 0.816 is ~4Hz cutoff at 10Hz sampling
-    float expAlpha = 0.816f;
-    float expAvg = 0.0f;
-    for (int loop = 0; loop < 4; loop++) {
-      expAvg = signal.front();
-      for (int idx = 0; idx < length; idx++) {
-        expAvg = (expAlpha * signal.at(idx)) + ((1 - expAlpha) * expAvg);
-        signal[idx] = expAvg;
-      }
-    }
-    expAlpha = 0.268f;
-    for (int loop = 0; loop < 4; loop++) {
-      expAvg = signal.front();
-      for (int idx = 0; idx < length; idx++) {
-        expAvg = (expAlpha * signal.at(idx)) + ((1 - expAlpha) * expAvg);
-        signal[idx] -= expAvg;
-      }
-    }
-  }
-
   float SpectrumMax(const std::array<float, Ppg::spectrumLength>& data, int start, int end) {
     float max = 0.0f;
     for (int idx = start; idx < end; idx++) {
@@ -113,17 +93,29 @@ namespace {
     return max;
   }
 
-  void Detrend(std::array<float, Ppg::dataLength>& signal) {
-    int size = signal.size();
-    float offset = signal.front();
-    float slope = (signal.at(size - 1) - offset) / static_cast<float>(size - 1);
-
-    for (int idx = 0; idx < size; idx++) {
-      signal[idx] -= (slope * static_cast<float>(idx) + offset);
+#ifdef PPG_FLOAT_FFT
+  // Simple bandpass filter using exponential moving average
+  // From:
+  // https://www.norwegiancreations.com/2016/03/arduino-tutorial-simple-high-pass-band-pass-and-band-stop-filtering/
+  // The stages are run one sample at a time, averages holds their state.
+  float Filter30to240(float value, float* averages) {
+    // 0.268 is ~0.5Hz and 0.816 is ~4Hz cutoff at 10Hz sampling
+    constexpr float lowPassAlpha = 0.816f;
+    constexpr float highPassAlpha = 0.268f;
+    for (int stage = 0; stage < Ppg::filterStages; stage++) {
+      averages[stage] = (lowPassAlpha * value) + ((1 - lowPassAlpha) * averages[stage]);
+      value = averages[stage];
     }
-    for (int idx = 0; idx < size - 1; idx++) {
-      signal[idx] = signal[idx + 1] - signal[idx];
+    for (int stage = Ppg::filterStages; stage < 2 * Ppg::filterStages; stage++) {
+      averages[stage] = (highPassAlpha * value) + ((1 - highPassAlpha) * averages[stage]);
+      value -= averages[stage];
     }
+    return value;
+  }
+
+  // Detrends the signal with its first difference, and filters it
+  float FilterSample(uint16_t hrs, uint16_t lastHRS, float* averages) {
+    return Filter30to240(static_cast<float>(hrs) - static_cast<float>(lastHRS), averages);
   }
 
   // Hanning Coefficients from numpy: python -c 'import numpy;print(numpy.hanning(64))'
@@ -135,6 +127,159 @@ namespace {
     0.15088159f, 0.1882551f,  0.22872687f, 0.27189467f, 0.31732949f, 0.36457977f, 0.41317591f, 0.46263495f,
     0.51246535f, 0.56217185f, 0.61126047f, 0.65924333f, 0.70564355f, 0.75f,       0.79187184f, 0.83084292f,
     0.86652594f, 0.89856625f, 0.92664544f, 0.95048443f, 0.96984631f, 0.98453864f, 0.99441541f, 0.99937846f};
+#else
+  // Q15 cosine of 2 * pi * k / 64 for k = 0 to 16, the other values of cos() and sin() are
+  // obtained by symmetry.
+  // Note: Harcoded and must be updated if constexpr dataLength is changed.
+  constexpr int16_t cosQ15[(Ppg::dataLength >> 2) + 1] {
+    32767, 32609, 32137, 31356, 30273, 28898, 27245, 25329, 23170, 20787, 18204, 15446, 12539, 9512, 6393, 3212, 0};
+
+  // Q15 Hanning coefficients, the first half of numpy.hanning(64) (see the float version)
+  constexpr int16_t hanningQ15[Ppg::dataLength >> 1] {
+    0,     81,    325,   728,   1286,  1995,  2847,  3833,  4944,  6169,  7495,  8909,  10398, 11946, 13539, 15159,
+    16792, 18421, 20029, 21601, 23122, 24575, 25947, 27224, 28393, 29443, 30363, 31145, 31779, 32260, 32584, 32747};
+
+  // Fractional bits of the filtered signal
+  constexpr int signalShift = 8;
+
+  int32_t CosQ15(int k) {
+    constexpr int quarter = Ppg::dataLength >> 2;
+    k &= Ppg::dataLength - 1;
+    if (k <= quarter) {
+      return cosQ15[k];
+    } else if (k <= 2 * quarter) {
+      return -cosQ15[2 * quarter - k];
+    } else if (k <= 3 * quarter) {
+      return -cosQ15[k - 2 * quarter];
+    }
+    return cosQ15[4 * quarter - k];
+  }
+
+  int32_t SinQ15(int k) {
+    return CosQ15(k - (Ppg::dataLength >> 2));
+  }
+
+  // Rounded value * coefficient, coefficient in Q15
+  int32_t MultiplyQ15(int32_t value, int32_t coefficient) {
+    return static_cast<int32_t>((static_cast<int64_t>(value) * coefficient + (1 << 14)) >> 15);
+  }
+
+  // Fixed point version of Filter30to240() above
+  int32_t Filter30to240(int32_t value, int32_t* averages) {
+    // 0.816 and 0.268 in Q15
+    constexpr int32_t lowPassAlpha = 26739;
+    constexpr int32_t highPassAlpha = 8782;
+    for (int stage = 0; stage < Ppg::filterStages; stage++) {
+      averages[stage] += MultiplyQ15(value - averages[stage], lowPassAlpha);
+      value = averages[stage];
+    }
+    for (int stage = Ppg::filterStages; stage < 2 * Ppg::filterStages; stage++) {
+      averages[stage] += MultiplyQ15(value - averages[stage], highPassAlpha);
+      value -= averages[stage];
+    }
+    return value;
+  }
+
+  // Detrends the signal with its first difference (Q8), and filters it
+  int32_t FilterSample(uint16_t hrs, uint16_t lastHRS, int32_t* averages) {
+    return Filter30to240((static_cast<int32_t>(hrs) - lastHRS) << signalShift, averages);
+  }
+
+  // In place radix-2 FFT of the complex values (interleaved real and imaginary parts) of data, with Q15
+  // twiddle factors. The values are not scaled: the magnitude of the results is at most length times the
+  // magnitude of the inputs, which must leave enough headroom (|x| < 2^24 for each part is enough).
+  void ComplexFft(int32_t* data, int length) {
+    for (int idx = 1, reversed = 0; idx < length; idx++) {
+      int bit = length >> 1;
+      for (; reversed & bit; bit >>= 1) {
+        reversed ^= bit;
+      }
+      reversed |= bit;
+      if (idx < reversed) {
+        std::swap(data[2 * idx], data[2 * reversed]);
+        std::swap(data[2 * idx + 1], data[2 * reversed + 1]);
+      }
+    }
+    for (int size = 2; size <= length; size <<= 1) {
+      const int half = size >> 1;
+      // Twiddle index in the table of dataLength values
+      const int step = Ppg::dataLength / size;
+      for (int group = 0; group < length; group += size) {
+        for (int k = 0; k < half; k++) {
+          const int32_t c = CosQ15(k * step);
+          const int32_t s = SinQ15(k * step);
+          int32_t* a = &data[2 * (group + k)];
+          int32_t* b = &data[2 * (group + k + half)];
+          const int32_t tReal = MultiplyQ15(b[0], c) + MultiplyQ15(b[1], s);
+          const int32_t tImag = MultiplyQ15(b[1], c) - MultiplyQ15(b[0], s);
+          b[0] = a[0] - tReal;
+          b[1] = a[1] - tImag;
+          a[0] += tReal;
+          a[1] += tImag;
+        }
+      }
+    }
+  }
+
+  // Magnitude of the first dataLength / 2 bins of the DFT of the windowed samples, a ring buffer whose oldest value
+  // is at first. signal is the work buffer: the dataLength real values are used as dataLength / 2 complex values
+  // (even samples as the real part, odd samples as the imaginary part), so that a half size complex FFT and a final
+  // split step compute the spectrum.
+  void RealFftMagnitude(const std::array<int32_t, Ppg::dataLength>& samples,
+                        int first,
+                        std::array<int32_t, Ppg::dataLength>& signal,
+                        std::array<float, Ppg::spectrumLength>& magnitudes) {
+    constexpr int length = Ppg::spectrumLength;
+    // Block floating point: scale the windowed values below 2^20, the FFT of length values stays below 2^26
+    constexpr int32_t maxInput = 1 << 20;
+    int32_t maxValue = 0;
+    for (int idx = 0; idx < Ppg::dataLength; idx++) {
+      const int32_t sample = samples[(first + idx) & (Ppg::dataLength - 1)];
+      signal[idx] = MultiplyQ15(sample, hanningQ15[idx < length ? idx : Ppg::dataLength - 1 - idx]);
+      maxValue = std::max(maxValue, signal[idx] < 0 ? -signal[idx] : signal[idx]);
+    }
+    // Scale down the large values, or up the small ones, never both: a negative shift count would be undefined
+    int shift = 0;
+    while ((maxValue >> shift) >= maxInput) {
+      shift++;
+    }
+    if (shift == 0) {
+      while (maxValue != 0 && (maxValue << -shift) < (maxInput >> 1)) {
+        shift--;
+      }
+    }
+    for (auto& value : signal) {
+      value = shift >= 0 ? (value >> shift) : (value << -shift);
+    }
+
+    int32_t* data = signal.data();
+    ComplexFft(data, length);
+
+    // Split step: X[k] = (Z[k] + conj(Z[N-k])) / 2 + W^k * (Z[k] - conj(Z[N-k])) / 2j, computed as 2 * X[k]
+    // The signal was scaled by 2^(shift - signalShift).
+    float scale = 0.5f;
+    for (int idx = 0; idx < signalShift - shift; idx++) {
+      scale /= 2.0f;
+    }
+    for (int idx = 0; idx < shift - signalShift; idx++) {
+      scale *= 2.0f;
+    }
+    for (int k = 0; k < length; k++) {
+      const int mirror = (length - k) & (length - 1);
+      const int32_t zReal = data[2 * k];
+      const int32_t zImag = data[2 * k + 1];
+      const int32_t mirrorReal = data[2 * mirror];
+      const int32_t mirrorImag = data[2 * mirror + 1];
+      const int32_t oddReal = zImag + mirrorImag;
+      const int32_t oddImag = mirrorReal - zReal;
+      const int32_t c = CosQ15(k);
+      const int32_t s = SinQ15(k);
+      const float real = static_cast<float>(zReal + mirrorReal + MultiplyQ15(oddReal, c) + MultiplyQ15(oddImag, s));
+      const float imag = static_cast<float>(zImag - mirrorImag + MultiplyQ15(oddImag, c) - MultiplyQ15(oddReal, s));
+      magnitudes[k] = sqrtf(real * real + imag * imag) * scale;
+    }
+  }
+#endif
 }
 
 Ppg::Ppg() {
@@ -143,8 +288,18 @@ Ppg::Ppg() {
 }
 
 int8_t Ppg::Preprocess(uint16_t hrs, uint16_t als) {
+  statistics.samples++;
+  if (dataIndex == 0) {
+    // First sample of a new acquisition
+    lastHRS = hrs;
+    filterAverages.fill(0);
+  }
+  // The newest sample replaces the oldest one, which becomes the next oldest
+  samples[samplesIndex] = FilterSample(hrs, lastHRS, filterAverages.data());
+  samplesIndex = (samplesIndex + 1) & (dataLength - 1);
+  lastHRS = hrs;
   if (dataIndex < dataLength) {
-    dataHRS[dataIndex++] = hrs;
+    dataIndex++;
   }
   alsValue = als;
   if (alsValue > alsThreshold) {
@@ -162,12 +317,17 @@ int Ppg::HeartRate() {
   }
   enoughData = true;
   int hr = 0;
+  const uint32_t start = Utility::CycleCounter::Now();
   hr = ProcessHeartRate(resetSpectralAvg);
-  resetSpectralAvg = false;
-  // Make room for overlapWindow number of new samples
-  for (int idx = 0; idx < dataLength - overlapWindow; idx++) {
-    dataHRS[idx] = dataHRS[idx + overlapWindow];
+  const uint32_t cycles = Utility::CycleCounter::Now() - start;
+  statistics.analyses++;
+  statistics.cycles += cycles;
+  statistics.maxCycles = std::max(statistics.maxCycles, cycles);
+  if (hr > 0 && statistics.samplesToFirstValue == 0) {
+    statistics.samplesToFirstValue = statistics.samples;
   }
+  resetSpectralAvg = false;
+  // Next analysis after overlapWindow new samples
   dataIndex = dataLength - overlapWindow;
   return hr;
 }
@@ -180,6 +340,7 @@ void Ppg::Reset(bool resetDaqBuffer) {
   avgIndex = 0;
   dataAverage.fill(0.0f);
   lastPeakLocation = 0.0f;
+  analysisHeartRate = 0;
   alsThreshold = UINT16_MAX;
   alsValue = 0;
   resetSpectralAvg = true;
@@ -189,27 +350,9 @@ void Ppg::Reset(bool resetDaqBuffer) {
 // Pass init == true to reset spectral averaging.
 // Returns -1 (Reset Acquisition), 0 (Unable to obtain HR) or HR (BPM).
 int Ppg::ProcessHeartRate(bool init) {
-  std::copy(dataHRS.begin(), dataHRS.end(), vReal.begin());
-  Detrend(vReal);
-  Filter30to240(vReal);
-  vImag.fill(0.0f);
-  // Apply Hanning Window
-  int hannIdx = 0;
-  for (int idx = 0; idx < dataLength; idx++) {
-    if (idx >= dataLength >> 1) {
-      hannIdx--;
-    }
-    vReal[idx] *= hanning[hannIdx];
-    if (idx < dataLength >> 1) {
-      hannIdx++;
-    }
-  }
-  // Compute in place power spectrum
-  ArduinoFFT<float> FFT = ArduinoFFT<float>(vReal.data(), vImag.data(), dataLength, sampleFreq);
-  FFT.compute(FFTDirection::Forward);
-  FFT.complexToMagnitude();
-  FFT.~ArduinoFFT();
-  SpectrumAverage(vReal.data(), spectrum.data(), spectrum.size(), init);
+  std::array<float, spectrumLength> magnitudes;
+  ComputeSpectrum(magnitudes);
+  SpectrumAverage(magnitudes.data(), spectrum.data(), spectrum.size(), init);
   peakLocation = 0.0f;
   float threshold = peakDetectionThreshold;
   float peakWidth = 0.0f;
@@ -218,17 +361,7 @@ int Ppg::ProcessHeartRate(bool init) {
   float signalToNoiseRatio = SignalToNoise(spectrum, hrROIbegin, hrROIend, max);
   if (signalToNoiseRatio > signalToNoiseThreshold && spectrum.at(0) < dcThreshold) {
     threshold *= max;
-    // Reuse VImag for interpolation x values passed to PeakSearch
-    for (int idx = 0; idx < dataLength; idx++) {
-      vImag[idx] = idx;
-    }
-    peakLocation = PeakSearch(vImag.data(),
-                              spectrum.data(),
-                              threshold,
-                              peakWidth,
-                              static_cast<float>(hrROIbegin),
-                              static_cast<float>(hrROIend),
-                              specLen);
+    peakLocation = PeakSearch(spectrum.data(), specLen, threshold, peakWidth, hrROIbegin, hrROIend);
     peakLocation *= freqResolution;
   }
   // Peak too wide? (broad spectrum noise or large, rapid HR change)
@@ -245,6 +378,7 @@ int Ppg::ProcessHeartRate(bool init) {
   }
   // Set the ambient light threshold and return HR in BPM
   alsThreshold = static_cast<uint16_t>(alsValue * alsFactor);
+  analysisHeartRate = static_cast<int>((peakLocation * 60.0f) + 0.5f);
   // Get current average HR. If HR reduced to zero, return -1 (reset) else HR
   peakLocation = HeartRateAverage(peakLocation);
   int rtn = -1;
@@ -257,6 +391,34 @@ int Ppg::ProcessHeartRate(bool init) {
   return rtn;
 }
 
+// Computes the magnitude of the spectrum of the windowed samples
+#ifdef PPG_FLOAT_FFT
+void Ppg::ComputeSpectrum(std::array<float, spectrumLength>& magnitudes) {
+  vImag.fill(0.0f);
+  // Copy the samples from the oldest one and apply Hanning Window
+  int hannIdx = 0;
+  for (int idx = 0; idx < dataLength; idx++) {
+    if (idx >= dataLength >> 1) {
+      hannIdx--;
+    }
+    vReal[idx] = samples[(samplesIndex + idx) & (dataLength - 1)] * hanning[hannIdx];
+    if (idx < dataLength >> 1) {
+      hannIdx++;
+    }
+  }
+  // Compute in place power spectrum
+  ArduinoFFT<float> FFT = ArduinoFFT<float>(vReal.data(), vImag.data(), dataLength, sampleFreq);
+  FFT.compute(FFTDirection::Forward);
+  FFT.complexToMagnitude();
+  FFT.~ArduinoFFT();
+  std::copy(vReal.begin(), vReal.begin() + spectrumLength, magnitudes.begin());
+}
+#else
+void Ppg::ComputeSpectrum(std::array<float, spectrumLength>& magnitudes) {
+  RealFftMagnitude(samples, samplesIndex, signal, magnitudes);
+}
+#endif
+
 void Ppg::SpectrumAverage(const float* data, float* spectrum, int length, bool reset) {
   if (reset) {
     spectralAvgCount = 0;
@@ -3,24 +3,55 @@
 #include <array>
 #include <cstddef>
 #include <cstdint>
+// The spectrum is computed in fixed point (integer FFT with Q15 twiddles). Define PPG_FLOAT_FFT to compute it
+// with floats and arduinoFFT instead.
+#ifdef PPG_FLOAT_FFT
 // Note: Change internal define 'sqrt_internal sqrt' to
 // 'sqrt_internal sqrtf' to save ~3KB of flash.
 #define sqrt_internal sqrtf
 #define FFT_SPEED_OVER_PRECISION
 #include "libs/arduinoFFT/src/arduinoFFT.h"
+#endif
 
 namespace Pinetime {
   namespace Controllers {
     class Ppg {
     public:
+      // Cost and latency of the measurement, to tune the constants below on the device
+      struct Statistics {
+        uint32_t samples = 0;
+        uint32_t analyses = 0;
+        // CPU cycles spent in the spectral analysis
+        uint32_t cycles = 0;
+        uint32_t maxCycles = 0;
+        // Number of samples before the first heart rate, 0 if there was none yet
+        uint32_t samplesToFirstValue = 0;
+      };
+
       Ppg();
       int8_t Preprocess(uint16_t hrs, uint16_t als);
       int HeartRate();
       void Reset(bool resetDaqBuffer);
+
+      // Heart rate (BPM) found by the last analysis, before it is averaged with the previous ones by HeartRate().
+      // 0 if the last analysis found none.
+      int LastAnalysisHeartRate() const {
+        return analysisHeartRate;
+      }
+
+      const Statistics& GetStatistics() const {
+        return statistics;
+      }
+
+      void ResetStatistics() {
+        statistics = {};
+      }
       static constexpr int deltaTms = 100;
       // Daq dataLength: Must be power of 2
       static constexpr uint16_t dataLength = 64;
       static constexpr uint16_t spectrumLength = dataLength >> 1;
+      // Number of exponential moving averages of each side of the band-pass filter
+      static constexpr uint16_t filterStages = 4;
 
     private:
       // The sampling frequency (Hz) based on sampling time in milliseconds (DeltaTms)
@@ -52,12 +83,26 @@ namespace Pinetime {
       // ALS detection factor
       static constexpr float alsFactor = 2.0f;
 
-      // Raw ADC data
-      std::array<uint16_t, dataLength> dataHRS;
+#ifdef PPG_FLOAT_FFT
+      using Sample = float;
+#else
+      // Q8
+      using Sample = int32_t;
+#endif
+
+      // Detrended and band-pass filtered samples, ring buffer of the last dataLength samples
+      std::array<Sample, dataLength> samples;
+      // Moving averages of the low-pass then of the high-pass stages of the band-pass filter
+      std::array<Sample, 2 * filterStages> filterAverages;
+#ifdef PPG_FLOAT_FFT
       // Stores Real numbers from FFT
       std::array<float, dataLength> vReal;
       // Stores Imaginary numbers from FFT
       std::array<float, dataLength> vImag;
+#else
+      // Windowed signal, then its FFT computed in place
+      std::array<int32_t, dataLength> signal;
+#endif
       // Stores power spectrum calculated from FFT real and imag values
       std::array<float, (spectrumLength)> spectrum;
       // Stores each new HR value (Hz). Non zero values are averaged for HR output
@@ -68,12 +113,20 @@ namespace Pinetime {
       float lastPeakLocation = 0.0f;
       uint16_t alsThreshold = UINT16_MAX;
       uint16_t alsValue = 0;
+      // Number of samples in the buffer, up to dataLength. The analysis runs when the buffer is full and leaves
+      // room for overlapWindow new samples.
       uint16_t dataIndex = 0;
+      // Position of the oldest sample in the buffer
+      uint16_t samplesIndex = 0;
+      uint16_t lastHRS = 0;
       float peakLocation;
+      int analysisHeartRate = 0;
       bool resetSpectralAvg = true;
       bool enoughData = false;
+      Statistics statistics;
 
       int ProcessHeartRate(bool init);
+      void ComputeSpectrum(std::array<float, spectrumLength>& magnitudes);
       float HeartRateAverage(float hr);
       void SpectrumAverage(const float* data, float* spectrum, int length, bool reset);
     };
@@ -0,0 +1,103 @@
+#include "components/heatshrink/HeatshrinkDecoder.h"
+
+#include <algorithm>
+
+using namespace Pinetime::Tools;
+
+HeatshrinkDecoder::HeatshrinkDecoder(ReadCallback read, void* context, uint32_t compressedSize)
+  : read {read}, context {context}, compressedSize {compressedSize} {
+}
+
+void HeatshrinkDecoder::Rewind() {
+  windowHead = 0;
+  inputLength = 0;
+  inputIndex = 0;
+  inputOffset = 0;
+  readError = false;
+  bitBuffer = 0;
+  bitCount = 0;
+  backrefDistance = 0;
+  backrefRemaining = 0;
+  position = 0;
+}
+
+int HeatshrinkDecoder::Decode(uint8_t* output, uint32_t size) {
+  uint32_t decoded = 0;
+  while (decoded < size) {
+    if (backrefRemaining > 0) {
+      // Copy as much of the backreference as fits in the output at once
+      uint32_t count = std::min<uint32_t>(backrefRemaining, size - decoded);
+      backrefRemaining -= count;
+      for (; count > 0; count--) {
+        const uint8_t byte = window[(windowHead - backrefDistance) & (windowSize - 1)];
+        window[windowHead] = byte;
+        windowHead = (windowHead + 1) & (windowSize - 1);
+        if (output != nullptr) {
+          output[decoded] = byte;
+        }
+        decoded++;
+      }
+      continue;
+    }
+
+    uint16_t tag;
+    if (!ReadBits(1, tag)) {
+      break;
+    }
+    if (tag != 0) {
+      uint16_t byte;
+      if (!ReadBits(8, byte)) {
+        break;
+      }
+      window[windowHead] = byte;
+      windowHead = (windowHead + 1) & (windowSize - 1);
+      if (output != nullptr) {
+        output[decoded] = byte;
+      }
+      decoded++;
+    } else {
+      uint16_t index;
+      uint16_t count;
+      if (!ReadBits(windowBits, index) || !ReadBits(lookaheadBits, count)) {
+        break;
+      }
+      backrefDistance = index + 1;
+      backrefRemaining = count + 1;
+    }
+  }
+
+  position += decoded;
+  if (readError) {
+    return -1;
+  }
+  return decoded;
+}
+
+bool HeatshrinkDecoder::ReadBits(uint8_t count, uint16_t& value) {
+  while (bitCount < count) {
+    if (inputIndex >= inputLength && !FillInput()) {
+      return false;
+    }
+    bitBuffer = (bitBuffer << 8) | input[inputIndex++];
+    bitCount += 8;
+  }
+  bitCount -= count;
+  value = (bitBuffer >> bitCount) & ((1 << count) - 1);
+  return true;
+}
+
+bool HeatshrinkDecoder::FillInput() {
+  if (inputOffset >= compressedSize || readError) {
+    return false;
+  }
+  const uint32_t size = std::min<uint32_t>(inputBufferSize, compressedSize - inputOffset);
+  const int result = read(context, inputOffset, input.data(), size);
+  if (result <= 0) {
+    readError = result < 0;
+    return false;
+  }
+  inputOffset += result;
+  inputLength = result;
+  inputIndex = 0;
+  return true;
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace Pinetime {
+  namespace Tools {
+    /* Streaming decoder for the heatshrink (LZSS) format, with a window of 2^windowBits bytes and
+     * backreferences of up to 2^lookaheadBits bytes. The stream is a sequence of bits, most significant first:
+     *
+     *   1 + 8 bits                     : literal byte
+     *   0 + windowBits + lookaheadBits : copy (count + 1) bytes from (index + 1) bytes back in the output
+     *
+     * The compressed data is read in small chunks through the callback given to the constructor, and decoded
+     * directly into the output buffers, so a resource never needs to be decompressed entirely in RAM.
+     * The format is produced by generate-package.py.
+     */
+    class HeatshrinkDecoder {
+    public:
+      // Reads up to size bytes at offset in the compressed data.
+      // Returns the number of bytes read or a negative value on error.
+      using ReadCallback = int (*)(void* context, uint32_t offset, uint8_t* buffer, uint32_t size);
+
+      HeatshrinkDecoder(ReadCallback read, void* context, uint32_t compressedSize);
+
+      HeatshrinkDecoder(const HeatshrinkDecoder&) = delete;
+      HeatshrinkDecoder& operator=(const HeatshrinkDecoder&) = delete;
+      HeatshrinkDecoder(HeatshrinkDecoder&&) = delete;
+      HeatshrinkDecoder& operator=(HeatshrinkDecoder&&) = delete;
+
+      // Decodes up to size bytes in output, or discards them if output is nullptr.
+      // Returns the number of bytes decoded, less than size at the end of the data, or a negative value on read error.
+      int Decode(uint8_t* output, uint32_t size);
+
+      // Restarts decoding from the beginning of the data
+      void Rewind();
+
+      // Position of the next decoded byte in the uncompressed data
+      uint32_t Position() const {
+        return position;
+      }
+
+      static constexpr uint8_t windowBits = 8;
+      static constexpr uint8_t lookaheadBits = 4;
+
+    private:
+      static constexpr uint16_t windowSize = 1 << windowBits;
+      static constexpr uint8_t inputBufferSize = 64;
+
+      // Returns false if the data ends before count bits (count <= 16)
+      bool ReadBits(uint8_t count, uint16_t& value);
+      bool FillInput();
+
+      ReadCallback read;
+      void* context;
+      uint32_t compressedSize;
+
+      std::array<uint8_t, windowSize> window;
+      uint16_t windowHead = 0;
+
+      std::array<uint8_t, inputBufferSize> input;
+      uint8_t inputLength = 0;
+      uint8_t inputIndex = 0;
+      uint32_t inputOffset = 0;
+      bool readError = false;
+
+      uint32_t bitBuffer = 0;
+      uint8_t bitCount = 0;
+
+      uint16_t backrefDistance = 0;
+      uint16_t backrefRemaining = 0;
+      uint32_t position = 0;
+    };
+  }
+}
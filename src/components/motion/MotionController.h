@@ -6,6 +6,7 @@
 
 #include "drivers/Bma421.h"
 #include "components/ble/MotionService.h"
+#include "components/changenotifier/ChangeNotifier.h"
 #include "utility/CircularBuffer.h"
 
 namespace Pinetime {
@@ -25,6 +26,9 @@ namespace Pinetime {
 
       static constexpr size_t stepHistorySize = 2; // Store this many day's step counter
 
+      explicit MotionController(ChangeNotifier& changeNotifier) : changeNotifier {changeNotifier} {
+      }
+
       void AdvanceDay();
 
       void Update(int16_t x, int16_t y, int16_t z, uint32_t nbSteps);
@@ -75,6 +79,7 @@ namespace Pinetime {
       }
 
     private:
+      ChangeNotifier& changeNotifier;
       Utility::CircularBuffer<uint32_t, stepHistorySize> nbSteps = {0};
       uint32_t currentTripSteps = 0;
 
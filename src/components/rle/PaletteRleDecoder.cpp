@@ -0,0 +1,141 @@
+#include "components/rle/PaletteRleDecoder.h"
+#include <algorithm>
+#include <cstring>
+#include "components/rle/PixelFill.h"
+
+using namespace Pinetime::Tools;
+
+PaletteRleDecoder::PaletteRleDecoder(const uint8_t* data, uint32_t size, uint16_t width)
+  : width {width}, input {data}, inputLength {size} {
+}
+
+PaletteRleDecoder::PaletteRleDecoder(ReadCallback read, void* context, uint16_t width)
+  : read {read}, context {context}, width {width}, inputLength {0} {
+  input = buffer.data();
+}
+
+bool PaletteRleDecoder::Init() {
+  uint8_t count;
+  if (!NextByte(count)) {
+    return false;
+  }
+  for (uint16_t i = 0; i <= count; i++) {
+    uint8_t bytes[2];
+    if (!NextByte(bytes[0]) || !NextByte(bytes[1])) {
+      return false;
+    }
+    std::memcpy(&palette[i], bytes, sizeof(bytes));
+  }
+  // Invalid indices decode to the first colour
+  std::fill(palette.begin() + count + 1, palette.end(), palette[0]);
+
+  linesOffset = Offset();
+  Rewind();
+  return true;
+}
+
+bool PaletteRleDecoder::DecodeLine(uint16_t y, uint16_t x, uint16_t length, uint8_t* output) {
+  if (y < line) {
+    if (y >= lastLine) {
+      Seek(lastLineOffset);
+      line = lastLine;
+    } else {
+      Rewind();
+    }
+  }
+  for (; line < y; line++) {
+    if (!DecodeCurrentLine(nullptr, 0, 0)) {
+      Rewind();
+      return false;
+    }
+  }
+
+  lastLine = line;
+  lastLineOffset = Offset();
+  if (!DecodeCurrentLine(output, x, length)) {
+    Rewind();
+    return false;
+  }
+  line++;
+  return true;
+}
+
+void PaletteRleDecoder::Rewind() {
+  Seek(linesOffset);
+  line = 0;
+  lastLine = 0;
+  lastLineOffset = linesOffset;
+}
+
+bool PaletteRleDecoder::DecodeCurrentLine(uint8_t* output, uint16_t x, uint16_t length) {
+  const uint16_t end = x + length;
+  uint16_t position = 0;
+  while (position < width) {
+    uint8_t header;
+    if (!NextByte(header)) {
+      return false;
+    }
+    const uint16_t count = (header & 0x7f) + 1;
+    if (position + count > width) {
+      return false;
+    }
+
+    if ((header & 0x80) != 0) {
+      uint8_t index;
+      if (!NextByte(index)) {
+        return false;
+      }
+      const uint16_t first = std::max(position, x);
+      const uint16_t last = std::min<uint16_t>(position + count, end);
+      if (output != nullptr && first < last) {
+        FillPixels(output + (first - x) * 2, palette[index], last - first);
+      }
+    } else {
+      for (uint16_t i = position; i < position + count; i++) {
+        uint8_t index;
+        if (!NextByte(index)) {
+          return false;
+        }
+        if (output != nullptr && i >= x && i < end) {
+          __builtin_memcpy(output + (i - x) * 2, &palette[index], sizeof(uint16_t));
+        }
+      }
+    }
+    position += count;
+  }
+  return true;
+}
+
+bool PaletteRleDecoder::NextByte(uint8_t& byte) {
+  if (inputIndex >= inputLength) {
+    if (read == nullptr) {
+      return false;
+    }
+    inputOffset += inputLength;
+    const int result = read(context, inputOffset, buffer.data(), buffer.size());
+    if (result <= 0) {
+      inputLength = 0;
+      inputIndex = 0;
+      return false;
+    }
+    inputLength = result;
+    inputIndex = 0;
+  }
+  byte = input[inputIndex++];
+  return true;
+}
+
+uint32_t PaletteRleDecoder::Offset() const {
+  return inputOffset + inputIndex;
+}
+
+void PaletteRleDecoder::Seek(uint32_t offset) {
+  if (read == nullptr || (offset >= inputOffset && offset < inputOffset + inputLength)) {
+    inputIndex = offset - inputOffset;
+    return;
+  }
+  // The buffer is filled from offset on the next byte
+  inputOffset = offset;
+  inputLength = 0;
+  inputIndex = 0;
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace Pinetime {
+  namespace Tools {
+    /* Decoder for palette based RLE images, generated by tools/rle_encode.py --lvgl:
+     *
+     *   palette : number of colours - 1 (u8), then the colours, RGB565 most significant byte first
+     *   lines   : the runs of each line, from top to bottom. A run doesn't cross the end of a line.
+     *             1ccccccc index       : (c + 1) pixels of the colour index
+     *             0ccccccc index...    : (c + 1) pixels, each with its own colour index
+     *
+     * Runs are written to the output with 32-bit stores. The pixels are written in the byte order of the
+     * palette, which is the order expected by the display and by LVGL (LV_COLOR_16_SWAP).
+     *
+     * Lines are decoded in order. Decoding a line above the last one decoded restarts from the top of the image,
+     * except for the last line, which can be decoded again (for areas that are side by side).
+     */
+    class PaletteRleDecoder {
+    public:
+      // Reads up to size bytes at offset in the data. Returns the number of bytes read, 0 at the end of the data
+      // or a negative value on error.
+      using ReadCallback = int (*)(void* context, uint32_t offset, uint8_t* buffer, uint32_t size);
+
+      // Image in memory
+      PaletteRleDecoder(const uint8_t* data, uint32_t size, uint16_t width);
+      // Image read in small chunks through read
+      PaletteRleDecoder(ReadCallback read, void* context, uint16_t width);
+
+      PaletteRleDecoder(const PaletteRleDecoder&) = delete;
+      PaletteRleDecoder& operator=(const PaletteRleDecoder&) = delete;
+      PaletteRleDecoder(PaletteRleDecoder&&) = delete;
+      PaletteRleDecoder& operator=(PaletteRleDecoder&&) = delete;
+
+      // Reads the palette, returns false if the data is invalid
+      bool Init();
+
+      // Decodes the pixels x to x + length - 1 of line y in output (2 bytes per pixel).
+      // Returns false if the data is invalid or ends before the line.
+      bool DecodeLine(uint16_t y, uint16_t x, uint16_t length, uint8_t* output);
+
+    private:
+      static constexpr uint8_t inputBufferSize = 64;
+
+      // Decodes the next line, or skips it if output is nullptr
+      bool DecodeCurrentLine(uint8_t* output, uint16_t x, uint16_t length);
+      void Rewind();
+      bool NextByte(uint8_t& byte);
+      uint32_t Offset() const;
+      void Seek(uint32_t offset);
+
+      ReadCallback read = nullptr;
+      void* context = nullptr;
+      uint16_t width;
+
+      const uint8_t* input;
+      uint32_t inputLength;
+      uint32_t inputIndex = 0;
+      // Offset of input in the data
+      uint32_t inputOffset = 0;
+      std::array<uint8_t, inputBufferSize> buffer;
+
+      std::array<uint16_t, 256> palette;
+      // Offset of the first line in the data
+      uint32_t linesOffset = 0;
+      // Next line to decode
+      uint16_t line = 0;
+      uint16_t lastLine = 0;
+      uint32_t lastLineOffset = 0;
+    };
+  }
+}
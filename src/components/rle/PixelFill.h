@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Pinetime {
+  namespace Tools {
+    // Writes count 16-bit pixels of value (in the byte order of the output buffer) at output, which doesn't need to
+    // be aligned. Two pixels are written per 32-bit store.
+    // __builtin_memcpy is inlined as a single store, std::memcpy is a library call since the firmware is built with
+    // -fno-builtin.
+    inline void FillPixels(uint8_t* output, uint16_t value, size_t count) {
+      const uint32_t pair = value | (static_cast<uint32_t>(value) << 16);
+      for (; count >= 2; count -= 2) {
+        __builtin_memcpy(output, &pair, sizeof(pair));
+        output += sizeof(pair);
+      }
+      if (count > 0) {
+        __builtin_memcpy(output, &value, sizeof(value));
+      }
+    }
+  }
+}
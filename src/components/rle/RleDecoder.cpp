@@ -1,4 +1,6 @@
 #include "components/rle/RleDecoder.h"
+#include <algorithm>
+#include "components/rle/PixelFill.h"
 
 using namespace Pinetime::Tools;
 
@@ -12,19 +14,22 @@ RleDecoder::RleDecoder(const uint8_t* buffer, size_t size, uint16_t foregroundCo
 
 void RleDecoder::DecodeNext(uint8_t* output, size_t maxBytes) {
   for (; encodedBufferIndex < size; encodedBufferIndex++) {
-    uint8_t rl = buffer[encodedBufferIndex] - processedCount;
-    while (rl) {
-      output[bp] = color >> 8;
-      output[bp + 1] = color & 0xff;
-      bp += 2;
-      rl -= 1;
-      processedCount++;
+    // The output is sent as is to the display, most significant byte first
+    const uint8_t bytes[2] = {static_cast<uint8_t>(color >> 8), static_cast<uint8_t>(color & 0xff)};
+    uint16_t pixel;
+    __builtin_memcpy(&pixel, bytes, sizeof(pixel));
 
-      if (bp >= maxBytes) {
-        bp = 0;
-        y += 1;
-        return;
-      }
+    // Emit the whole run at once, or as much of it as fits in the output
+    const uint8_t rl = buffer[encodedBufferIndex] - processedCount;
+    const size_t count = std::min<size_t>(rl, (maxBytes - bp) / 2);
+    FillPixels(output + bp, pixel, count);
+    bp += count * 2;
+    processedCount += count;
+
+    if (bp >= maxBytes) {
+      bp = 0;
+      y += 1;
+      return;
     }
     processedCount = 0;
 
@@ -7,6 +7,7 @@ namespace Pinetime {
 
   namespace Components {
     class LittleVgl;
+    class FontCache;
   }
 
   namespace Controllers {
@@ -53,6 +54,7 @@ namespace Pinetime {
       Pinetime::Components::LittleVgl& lvgl;
       Pinetime::Controllers::MusicService* musicService;
       Pinetime::Controllers::NavigationService* navigationService;
+      Pinetime::Components::FontCache& fontCache;
     };
   }
 }
@@ -75,6 +75,19 @@ namespace {
     auto* dispApp = static_cast<DisplayApp*>(pvTimerGetTimerID(xTimer));
     dispApp->PushMessage(Display::Messages::TimerDone);
   }
+
+  // Screens that redraw large parts of the display on every frame render in fewer passes
+  // with taller render buffers, if the heap allows it
+  uint8_t RenderBufferLines(Apps app) {
+    switch (app) {
+      case Apps::Clock:
+      case Apps::Paddle:
+      case Apps::Twos:
+        return 24;
+      default:
+        return 4;
+    }
+  }
 }
 
 DisplayApp::DisplayApp(Drivers::St7789& lcd,
@@ -93,7 +106,8 @@ DisplayApp::DisplayApp(Drivers::St7789& lcd,
                        Pinetime::Controllers::BrightnessController& brightnessController,
                        Pinetime::Controllers::TouchHandler& touchHandler,
                        Pinetime::Controllers::FS& filesystem,
-                       Pinetime::Drivers::SpiNorFlash& spiNorFlash)
+                       Pinetime::Drivers::SpiNorFlash& spiNorFlash,
+                       Pinetime::Controllers::ChangeNotifier& changeNotifier)
   : lcd {lcd},
     touchPanel {touchPanel},
     batteryController {batteryController},
@@ -111,7 +125,9 @@ DisplayApp::DisplayApp(Drivers::St7789& lcd,
     touchHandler {touchHandler},
     filesystem {filesystem},
     spiNorFlash {spiNorFlash},
+    changeNotifier {changeNotifier},
     lvgl {lcd, filesystem},
+    fontCache {filesystem},
     timer(this, TimerCallback),
     controllers {batteryController,
                  bleController,
@@ -131,11 +147,13 @@ DisplayApp::DisplayApp(Drivers::St7789& lcd,
                  this,
                  lvgl,
                  nullptr,
-                 nullptr} {
+                 nullptr,
+                 fontCache} {
 }
 
 void DisplayApp::Start(System::BootErrors error) {
   msgQueue = xQueueCreate(queueSize, itemSize);
+  changeNotifier.Register(this);
 
   bootError = error;
 
@@ -235,6 +253,10 @@ void DisplayApp::Refresh() {
     return lv_disp_get_inactive_time(nullptr) >= pdMS_TO_TICKS(settingsController.GetScreenTimeOut());
   };
 
+  if (state != States::Idle) {
+    RefreshOnStateChanges(false);
+  }
+
   TickType_t queueTimeout;
   switch (state) {
     case States::Idle:
@@ -335,6 +357,7 @@ void DisplayApp::Refresh() {
         lvgl.ClearTouchState();
         if (msg == Messages::GoToAOD) {
           lcd.LowPowerOn();
+          UpdateAlwaysOnBand();
           // Record idle entry time
           alwaysOnFrameCount = 0;
           alwaysOnStartTime = xTaskGetTickCount();
@@ -342,6 +365,7 @@ void DisplayApp::Refresh() {
           state = States::AOD;
         } else {
           lcd.Sleep();
+          changeNotifier.Subscribe(0);
           PushMessageToSystemTask(Pinetime::System::Messages::OnDisplayTaskSleeping);
           state = States::Idle;
         }
@@ -357,9 +381,12 @@ void DisplayApp::Refresh() {
           break;
         }
         if (state == States::AOD) {
+          ClearAlwaysOnBand();
           lcd.LowPowerOff();
         } else {
           lcd.Wakeup();
+          SubscribeScreenTopics();
+          RefreshOnStateChanges(true);
         }
         lv_disp_trig_activity(nullptr);
         ApplyBrightness();
@@ -368,6 +395,9 @@ void DisplayApp::Refresh() {
       case Messages::UpdateBleConnection:
         // Only used for recovery firmware
         break;
+      case Messages::StateChanged:
+        // Handled at the beginning of the next refresh
+        break;
       case Messages::NewNotification:
         LoadNewScreen(Apps::NotificationsPreview, DisplayApp::FullRefreshDirections::Down);
         break;
@@ -521,9 +551,49 @@ void DisplayApp::LoadScreen(Apps app, DisplayApp::FullRefreshDirections directio
   lv_disp_trig_activity(nullptr);
   motorController.StopRinging();
 
+  if (currentScreen != nullptr) {
+    NRF_LOG_INFO("[DisplayApp] Screen refreshed %d times in %dms",
+                 currentScreen->RefreshCount(),
+                 (xTaskGetTickCount() - screenLoadTime) * 1000 / configTICK_RATE_HZ);
+  }
+  if (currentScreen != nullptr && app != currentApp && ScreenCache::IsCacheable(currentApp)) {
+    screenCache.Store(currentApp, std::move(currentScreen), lv_scr_act());
+    lv_scr_load(lv_obj_create(nullptr, nullptr));
+  }
   currentScreen.reset(nullptr);
   SetFullRefresh(direction);
 
+  if (app == Apps::Settings) {
+    // Settings can change what the cached screens show, like the watch face itself
+    screenCache.Clear();
+  }
+  // The render buffers of the previous screen must be freed before the next screen is created, they are
+  // allocated again afterwards from what the screen left, within the heap reserve (SetRenderBufferLines)
+  lvgl.FreeRenderBuffers();
+  screenCache.Shrink(screenCacheHeapReserve);
+  fontCache.Shrink(screenCacheHeapReserve);
+
+  currentScreen = screenCache.Restore(app);
+  const bool restored = currentScreen != nullptr;
+  if (!restored) {
+    CreateScreen(app);
+  }
+
+  // Only once the screen is created, see FreeRenderBuffers() above
+  lvgl.SetRenderBufferLines(RenderBufferLines(app));
+  currentApp = app;
+  screenLoadTime = xTaskGetTickCount();
+  SubscribeScreenTopics();
+  if (restored) {
+    // The screen was not refreshed while it was hidden
+    RefreshOnStateChanges(true);
+  }
+  if (state == States::AOD) {
+    UpdateAlwaysOnBand();
+  }
+}
+
+void DisplayApp::CreateScreen(Apps app) {
   // Reset screen background color based on app type
   // Watch faces keep black background, other apps use theme color
   if (app == Apps::Clock) {
@@ -676,7 +746,57 @@ void DisplayApp::LoadScreen(Apps app, DisplayApp::FullRefreshDirections directio
       break;
     }
   }
-  currentApp = app;
+}
+
+void DisplayApp::SubscribeScreenTopics() {
+  changeNotifier.Subscribe(currentScreen->RefreshTopics());
+  dateTimeController.CurrentDateTime();
+  notifiedMinute = dateTimeController.Minutes();
+  nextTimeCheck = xTaskGetTickCount();
+}
+
+void DisplayApp::RefreshOnStateChanges(bool force) {
+  using Controllers::ChangeNotifier;
+  ChangeNotifier::TopicMask changes = changeNotifier.TakePending();
+
+  // A notified time change (SetTime, time zone) re-syncs the next minute check with the new time
+  const TickType_t now = xTaskGetTickCount();
+  if ((changeNotifier.Subscriptions() & ChangeNotifier::Mask(ChangeNotifier::Topics::Time)) != 0 &&
+      ((changes & ChangeNotifier::Mask(ChangeNotifier::Topics::Time)) != 0 || static_cast<int32_t>(now - nextTimeCheck) >= 0)) {
+    dateTimeController.CurrentDateTime();
+    const uint8_t seconds = dateTimeController.Seconds();
+    if (dateTimeController.Minutes() != notifiedMinute) {
+      notifiedMinute = dateTimeController.Minutes();
+      changes |= ChangeNotifier::Mask(ChangeNotifier::Topics::Time);
+    }
+    if (seconds < 59) {
+      nextTimeCheck = now + (59 - seconds) * configTICK_RATE_HZ;
+    } else {
+      nextTimeCheck = now + configTICK_RATE_HZ / 8;
+    }
+  }
+
+  if (changes != 0 || (force && changeNotifier.Subscriptions() != 0)) {
+    currentScreen->OnStateChanged();
+  }
+}
+
+void DisplayApp::UpdateAlwaysOnBand() {
+  lv_coord_t y = 0;
+  lv_coord_t height = 0;
+  if (currentScreen->GetAlwaysOnBand(y, height) && y >= 0 && height > 0 && y + height <= LV_VER_RES) {
+    lvgl.SetPartialBand(y, height);
+    lcd.PartialModeOn(y, y + height - 1);
+  } else {
+    ClearAlwaysOnBand();
+  }
+}
+
+void DisplayApp::ClearAlwaysOnBand() {
+  if (lvgl.HasPartialBand()) {
+    lcd.PartialModeOff();
+    lvgl.ClearPartialBand();
+  }
 }
 
 void DisplayApp::PushMessage(Messages msg) {
@@ -689,7 +809,8 @@ void DisplayApp::PushMessage(Messages msg) {
     // Make xQueueSend() non-blocking if the message is a Notification message. We do this to avoid
     // deadlock between SystemTask and DisplayApp when their respective message queues are getting full
     // when a lot of notifications are received on a very short time span.
-    if (msg == Messages::NewNotification) {
+    // StateChanged only wakes DisplayApp up, the changes are picked up on the next refresh even if it is dropped.
+    if (msg == Messages::NewNotification || msg == Messages::StateChanged) {
       timeout = static_cast<TickType_t>(0);
     }
 
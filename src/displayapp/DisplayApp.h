@@ -6,6 +6,8 @@
 #include <systemtask/Messages.h>
 #include "displayapp/apps/Apps.h"
 #include "displayapp/LittleVgl.h"
+#include "displayapp/FontCache.h"
+#include "displayapp/ScreenCache.h"
 #include "displayapp/TouchEvents.h"
 #include "components/brightness/BrightnessController.h"
 #include "components/motor/MotorController.h"
@@ -22,6 +24,7 @@
 
 #include "utility/StaticStack.h"
 #include "displayapp/Controllers.h"
+#include "components/changenotifier/ChangeNotifier.h"
 
 namespace Pinetime {
 
@@ -69,7 +72,8 @@ namespace Pinetime {
                  Pinetime::Controllers::BrightnessController& brightnessController,
                  Pinetime::Controllers::TouchHandler& touchHandler,
                  Pinetime::Controllers::FS& filesystem,
-                 Pinetime::Drivers::SpiNorFlash& spiNorFlash);
+                 Pinetime::Drivers::SpiNorFlash& spiNorFlash,
+                 Pinetime::Controllers::ChangeNotifier& changeNotifier);
       void Start(System::BootErrors error);
       void PushMessage(Display::Messages msg);
 
@@ -101,9 +105,11 @@ namespace Pinetime {
       Pinetime::Controllers::TouchHandler& touchHandler;
       Pinetime::Controllers::FS& filesystem;
       Pinetime::Drivers::SpiNorFlash& spiNorFlash;
+      Pinetime::Controllers::ChangeNotifier& changeNotifier;
 
       Pinetime::Controllers::FirmwareValidator validator;
       Pinetime::Components::LittleVgl lvgl;
+      Pinetime::Components::FontCache fontCache;
       Pinetime::Controllers::Timer timer;
 
       AppControllers controllers;
@@ -116,6 +122,9 @@ namespace Pinetime {
       static constexpr uint8_t itemSize = 1;
 
       std::unique_ptr<Screens::Screen> currentScreen;
+      ScreenCache screenCache;
+      // Heap that must be free before creating a new screen, cached screens are destroyed to make room for it
+      static constexpr size_t screenCacheHeapReserve = 16 * 1024;
 
       Apps currentApp = Apps::None;
       Apps returnToApp = Apps::None;
@@ -128,12 +137,17 @@ namespace Pinetime {
       void Refresh();
       void LoadNewScreen(Apps app, DisplayApp::FullRefreshDirections direction);
       void LoadScreen(Apps app, DisplayApp::FullRefreshDirections direction);
+      void CreateScreen(Apps app);
       void PushMessageToSystemTask(Pinetime::System::Messages message);
 
       Apps nextApp = Apps::None;
       DisplayApp::FullRefreshDirections nextDirection;
       System::BootErrors bootError;
       void ApplyBrightness();
+      void UpdateAlwaysOnBand();
+      void SubscribeScreenTopics();
+      void RefreshOnStateChanges(bool force);
+      void ClearAlwaysOnBand();
 
       static constexpr size_t returnAppStackSize = 10;
       Utility::StaticStack<Apps, returnAppStackSize> returnAppStack;
@@ -141,6 +155,11 @@ namespace Pinetime {
 
       bool isDimmed = false;
 
+      TickType_t screenLoadTime = 0;
+      // Minute changes are checked shortly before the end of the minute, instead of on every refresh
+      TickType_t nextTimeCheck = 0;
+      uint8_t notifiedMinute = 0;
+
       TickType_t CalculateSleepTime();
       TickType_t alwaysOnFrameCount;
       TickType_t alwaysOnStartTime;
@@ -35,6 +35,7 @@ namespace Pinetime {
     class AlarmController;
     class BrightnessController;
     class FS;
+    class ChangeNotifier;
     class SimpleWeatherService;
     class MusicService;
     class NavigationService;
@@ -63,7 +64,8 @@ namespace Pinetime {
                  Pinetime::Controllers::BrightnessController& brightnessController,
                  Pinetime::Controllers::TouchHandler& touchHandler,
                  Pinetime::Controllers::FS& filesystem,
-                 Pinetime::Drivers::SpiNorFlash& spiNorFlash);
+                 Pinetime::Drivers::SpiNorFlash& spiNorFlash,
+                 Pinetime::Controllers::ChangeNotifier& changeNotifier);
       void Start();
 
       void Start(Pinetime::System::BootErrors) {
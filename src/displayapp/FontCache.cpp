@@ -0,0 +1,168 @@
+#include "displayapp/FontCache.h"
+
+#include <cstdio>
+#include <cstring>
+#include <FreeRTOS.h>
+#include <libraries/log/nrf_log.h>
+#include "components/fs/FS.h"
+#include "displayapp/StreamingFont.h"
+#include "utility/CycleCounter.h"
+
+using namespace Pinetime::Components;
+
+FontCache::FontCache(Pinetime::Controllers::FS& filesystem) : filesystem {filesystem} {
+}
+
+lv_font_t* FontCache::Acquire(const char* path, bool resident) {
+  return Acquire(path, resident, false);
+}
+
+lv_font_t* FontCache::AcquireStreamed(const char* path, bool resident) {
+  return Acquire(path, resident, true);
+}
+
+lv_font_t* FontCache::Acquire(const char* path, bool resident, bool streamed) {
+  Entry* entry = Find(path);
+  if (entry != nullptr) {
+    entry->references++;
+    entry->resident |= resident;
+    entry->lastUse = ++useCount;
+    statistics.hits++;
+    statistics.savedTimeUs += entry->loadTimeUs;
+    NRF_LOG_INFO("[FontCache] %s found, %dus saved", path, entry->loadTimeUs);
+    return entry->font;
+  }
+
+  if (std::strlen(path) >= maxPathLength) {
+    return nullptr;
+  }
+  uint32_t size;
+  Controllers::ResourceBundle::Resource resource;
+  lfs_info info;
+  if (filesystem.Resources().Find(path, resource)) {
+    size = resource.size;
+  } else if (filesystem.Stat(path, &info) == LFS_ERR_OK) {
+    size = info.size;
+  } else {
+    return nullptr;
+  }
+
+  const uint32_t start = Utility::CycleCounter::Now();
+  lv_font_t* font = nullptr;
+  if (streamed) {
+    auto* streamingFont = new StreamingFont(filesystem);
+    if (streamingFont->Load(path)) {
+      font = streamingFont->GetFont();
+      size = streamingFont->MemoryUsage() + StreamingFont::cacheSize;
+    } else {
+      delete streamingFont;
+    }
+  } else {
+    char lvglPath[maxPathLength + 2];
+    snprintf(lvglPath, sizeof(lvglPath), "R:%s", path);
+    font = lv_font_load(lvglPath);
+  }
+  const uint32_t loadTimeUs = Utility::CycleCounter::ToMicroseconds(Utility::CycleCounter::Now() - start);
+  if (font == nullptr) {
+    return nullptr;
+  }
+  statistics.loads++;
+  statistics.loadTimeUs += loadTimeUs;
+  NRF_LOG_INFO("[FontCache] %s loaded in %dus", path, loadTimeUs);
+
+  for (auto& e : entries) {
+    if (e.font == nullptr) {
+      entry = &e;
+      break;
+    }
+  }
+  if (entry == nullptr) {
+    entry = LeastRecentlyUsedUnused();
+    if (entry == nullptr) {
+      // All the entries are in use, the font is freed as soon as it is released
+      return font;
+    }
+    Unload(*entry);
+  }
+
+  entry->font = font;
+  std::strncpy(entry->path.data(), path, entry->path.size());
+  entry->size = size;
+  entry->loadTimeUs = loadTimeUs;
+  entry->lastUse = ++useCount;
+  entry->references = 1;
+  entry->resident = resident;
+  return font;
+}
+
+void FontCache::Release(lv_font_t* font) {
+  if (font == nullptr) {
+    return;
+  }
+
+  for (auto& entry : entries) {
+    if (entry.font == font) {
+      entry.references--;
+      while (UnusedSize() > maxUnusedSize) {
+        Unload(*LeastRecentlyUsedUnused());
+      }
+      return;
+    }
+  }
+
+  Free(font);
+}
+
+void FontCache::Shrink(size_t minFreeHeap) {
+  while (xPortGetFreeHeapSize() < minFreeHeap) {
+    Entry* entry = LeastRecentlyUsedUnused();
+    if (entry == nullptr) {
+      return;
+    }
+    Unload(*entry);
+  }
+}
+
+FontCache::Entry* FontCache::Find(const char* path) {
+  for (auto& entry : entries) {
+    if (entry.font != nullptr && std::strncmp(entry.path.data(), path, entry.path.size()) == 0) {
+      return &entry;
+    }
+  }
+  return nullptr;
+}
+
+FontCache::Entry* FontCache::LeastRecentlyUsedUnused() {
+  Entry* lru = nullptr;
+  for (auto& entry : entries) {
+    if (entry.font != nullptr && entry.references == 0 && !entry.resident && (lru == nullptr || entry.lastUse < lru->lastUse)) {
+      lru = &entry;
+    }
+  }
+  return lru;
+}
+
+size_t FontCache::UnusedSize() const {
+  size_t size = 0;
+  for (const auto& entry : entries) {
+    if (entry.font != nullptr && entry.references == 0 && !entry.resident) {
+      size += entry.size;
+    }
+  }
+  return size;
+}
+
+void FontCache::Unload(Entry& entry) {
+  NRF_LOG_INFO("[FontCache] Unloading a font of %d bytes", entry.size);
+  Free(entry.font);
+  entry = {};
+}
+
+void FontCache::Free(lv_font_t* font) {
+  StreamingFont* streamingFont = StreamingFont::FromFont(font);
+  if (streamingFont != nullptr) {
+    delete streamingFont;
+  } else {
+    lv_font_free(font);
+  }
+}
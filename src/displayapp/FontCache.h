@@ -0,0 +1,78 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <lvgl/lvgl.h>
+
+namespace Pinetime {
+  namespace Controllers {
+    class FS;
+  }
+
+  namespace Components {
+    // Fonts loaded from the filesystem with lv_font_load(), shared by the screens using them.
+    // Fonts are reference counted, and stay loaded once released as long as the unused fonts
+    // fit in maxUnusedSize, so showing the same watch face again doesn't parse them again from the SPI flash.
+    class FontCache {
+    public:
+      struct Statistics {
+        uint32_t hits = 0;
+        uint32_t loads = 0;
+        uint32_t loadTimeUs = 0;
+        // Load time of the fonts that were found in the cache
+        uint32_t savedTimeUs = 0;
+      };
+
+      explicit FontCache(Pinetime::Controllers::FS& filesystem);
+
+      FontCache(const FontCache&) = delete;
+      FontCache& operator=(const FontCache&) = delete;
+      FontCache(FontCache&&) = delete;
+      FontCache& operator=(FontCache&&) = delete;
+
+      // Returns the font stored at path in the filesystem ("/fonts/teko.bin"), or nullptr if it doesn't exist.
+      // A resident font is never unloaded, even when it isn't used anymore.
+      lv_font_t* Acquire(const char* path, bool resident = false);
+      // Same as Acquire(), but only the index of the font is loaded: its glyphs are read from the filesystem when
+      // they are drawn (see StreamingFont). Meant for large fonts, that would use too much RAM otherwise.
+      lv_font_t* AcquireStreamed(const char* path, bool resident = false);
+      void Release(lv_font_t* font);
+
+      // Unloads unused fonts until at least minFreeHeap bytes of heap are free
+      void Shrink(size_t minFreeHeap);
+
+      const Statistics& GetStatistics() const {
+        return statistics;
+      }
+
+    private:
+      static constexpr size_t maxPathLength = 32;
+      static constexpr size_t maxUnusedSize = 12 * 1024;
+
+      struct Entry {
+        lv_font_t* font = nullptr;
+        std::array<char, maxPathLength> path;
+        // Size of the font file, lv_font_load() allocates about as much.
+        // For streamed fonts, size of their index and glyph cache.
+        uint32_t size = 0;
+        uint32_t loadTimeUs = 0;
+        uint32_t lastUse = 0;
+        uint8_t references = 0;
+        bool resident = false;
+      };
+
+      lv_font_t* Acquire(const char* path, bool resident, bool streamed);
+      Entry* Find(const char* path);
+      Entry* LeastRecentlyUsedUnused();
+      size_t UnusedSize() const;
+      void Unload(Entry& entry);
+      static void Free(lv_font_t* font);
+
+      Pinetime::Controllers::FS& filesystem;
+      std::array<Entry, 6> entries;
+      uint32_t useCount = 0;
+      Statistics statistics;
+    };
+  }
+}
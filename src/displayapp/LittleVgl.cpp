@@ -3,9 +3,16 @@
 
 #include <FreeRTOS.h>
 #include <task.h>
+#include <libraries/log/nrf_log.h>
 #include "drivers/St7789.h"
 #include "littlefs/lfs.h"
 #include "components/fs/FS.h"
+#include "components/heatshrink/HeatshrinkDecoder.h"
+#include "displayapp/RleImageDecoder.h"
+#include "utility/CycleCounter.h"
+#include <algorithm>
+#include <cstring>
+#include <new>
 
 using namespace Pinetime::Components;
 
@@ -51,6 +58,99 @@ namespace {
     filesys->FileSeek(file, pos);
     return LV_FS_RES_OK;
   }
+
+  // Resources opened with the 'R' driver are read from the resource bundle,
+  // or from their own file if the bundle isn't installed or doesn't contain them.
+  // Compressed resources are decoded while they are read, directly into the buffer of LVGL.
+  struct ResourceFile {
+    Pinetime::Controllers::ResourceBundle::Resource resource;
+    uint32_t position;
+    bool packed;
+    lfs_file_t file;
+    Pinetime::Controllers::FS* filesystem;
+    Pinetime::Tools::HeatshrinkDecoder* decoder;
+  };
+
+  int resourceReadCompressed(void* context, uint32_t offset, uint8_t* buffer, uint32_t size) {
+    auto* file = static_cast<ResourceFile*>(context);
+    return file->filesystem->Resources().Read(file->resource.offset + offset, buffer, size);
+  }
+
+  lv_fs_res_t resourceOpen(lv_fs_drv_t* drv, void* file_p, const char* path, lv_fs_mode_t mode) {
+    auto* file = static_cast<ResourceFile*>(file_p);
+    file->filesystem = static_cast<Pinetime::Controllers::FS*>(drv->user_data);
+    file->position = 0;
+    file->decoder = nullptr;
+    file->packed = file->filesystem->Resources().Find(path, file->resource);
+    if (!file->packed) {
+      return lvglOpen(drv, &file->file, path, mode);
+    }
+    if (file->resource.compressedSize > 0) {
+      // Built without exceptions, a plain new would abort instead of returning nullptr
+      file->decoder = new (std::nothrow) Pinetime::Tools::HeatshrinkDecoder(resourceReadCompressed, file, file->resource.compressedSize);
+      if (file->decoder == nullptr) {
+        return LV_FS_RES_OUT_OF_MEM;
+      }
+    }
+    return LV_FS_RES_OK;
+  }
+
+  lv_fs_res_t resourceClose(lv_fs_drv_t* drv, void* file_p) {
+    auto* file = static_cast<ResourceFile*>(file_p);
+    if (file->packed) {
+      delete file->decoder;
+      file->decoder = nullptr;
+      return LV_FS_RES_OK;
+    }
+    return lvglClose(drv, &file->file);
+  }
+
+  // Seeking only moves the position, the decoder catches up on the next read: it skips the data
+  // up to the position, or restarts from the beginning of the resource if the position is behind it.
+  int resourceDecode(ResourceFile* file, uint8_t* buffer, uint32_t size) {
+    auto* decoder = file->decoder;
+    if (file->position < decoder->Position()) {
+      decoder->Rewind();
+    }
+    if (file->position > decoder->Position()) {
+      const int res = decoder->Decode(nullptr, file->position - decoder->Position());
+      if (res < 0) {
+        return res;
+      }
+    }
+    return decoder->Decode(buffer, size);
+  }
+
+  lv_fs_res_t resourceRead(lv_fs_drv_t* drv, void* file_p, void* buf, uint32_t btr, uint32_t* br) {
+    auto* file = static_cast<ResourceFile*>(file_p);
+    if (!file->packed) {
+      return lvglRead(drv, &file->file, buf, btr, br);
+    }
+
+    const uint32_t size = std::min(btr, file->resource.size - file->position);
+    int res;
+    if (file->decoder != nullptr) {
+      res = resourceDecode(file, static_cast<uint8_t*>(buf), size);
+    } else {
+      res = file->filesystem->Resources().Read(file->resource.offset + file->position, static_cast<uint8_t*>(buf), size);
+    }
+    if (res < 0) {
+      *br = 0;
+      return LV_FS_RES_FS_ERR;
+    }
+    file->position += res;
+    *br = res;
+    return LV_FS_RES_OK;
+  }
+
+  lv_fs_res_t resourceSeek(lv_fs_drv_t* drv, void* file_p, uint32_t pos) {
+    auto* file = static_cast<ResourceFile*>(file_p);
+    if (!file->packed) {
+      return lvglSeek(drv, &file->file, pos);
+    }
+    file->position = std::min(pos, file->resource.size);
+    return LV_FS_RES_OK;
+  }
 }
 
 static void disp_flush(lv_disp_drv_t* disp_drv, const lv_area_t* area, lv_color_t* color_p) {
@@ -58,6 +158,11 @@ static void disp_flush(lv_disp_drv_t* disp_drv, const lv_area_t* area, lv_color_
   lvgl->FlushDisplay(area, color_p);
 }
 
+static void monitor(lv_disp_drv_t* disp_drv, uint32_t time, uint32_t px) {
+  auto* lvgl = static_cast<LittleVgl*>(disp_drv->user_data);
+  lvgl->OnRefreshDone(time, px);
+}
+
 static void rounder(lv_disp_drv_t* disp_drv, lv_area_t* area) {
   auto* lvgl = static_cast<LittleVgl*>(disp_drv->user_data);
   if (lvgl->GetFullRefresh()) {
@@ -66,6 +171,71 @@ static void rounder(lv_disp_drv_t* disp_drv, lv_area_t* area) {
     area->y1 = 0;
     area->y2 = LV_VER_RES - 1;
   }
+  if (lvgl->HasPartialBand()) {
+    lvgl->ClipToPartialBand(area);
+  }
+}
+
+namespace {
+  // Blending kernel used by LVGL for unmasked images drawn with an opacity.
+  // Two RGB565 pixels are processed per 32-bit word: each colour channel of both pixels is extracted into its own
+  // 16-bit lane, which is wide enough to hold channel * opacity, so a single 32-bit multiply blends both pixels.
+  // The result is bit-exact with lv_color_mix().
+  inline uint32_t SwapPixelBytes(uint32_t pixels) {
+#if LV_COLOR_16_SWAP
+  #if defined(__ARM_ARCH_7EM__)
+    return __REV16(pixels);
+  #else
+    return ((pixels & 0xff00ff00) >> 8) | ((pixels & 0x00ff00ff) << 8);
+  #endif
+#else
+    return pixels;
+#endif
+  }
+
+  inline uint32_t Div255Lanes(uint32_t lanes) {
+    lanes += 0x00800080; // LV_COLOR_MIX_ROUND_OFS
+    return (lanes + ((lanes >> 8) & 0x00ff00ff) + 0x00010001) >> 8;
+  }
+
+  inline uint32_t BlendPixelPair(uint32_t src, uint32_t dest, uint32_t opa) {
+    src = SwapPixelBytes(src);
+    dest = SwapPixelBytes(dest);
+    const uint32_t invOpa = 255 - opa;
+    uint32_t red = Div255Lanes(((src >> 11) & 0x001f001f) * opa + ((dest >> 11) & 0x001f001f) * invOpa) & 0x001f001f;
+    uint32_t green = Div255Lanes(((src >> 5) & 0x003f003f) * opa + ((dest >> 5) & 0x003f003f) * invOpa) & 0x003f003f;
+    uint32_t blue = Div255Lanes((src & 0x001f001f) * opa + (dest & 0x001f001f) * invOpa) & 0x001f001f;
+    return SwapPixelBytes((red << 11) | (green << 5) | blue);
+  }
+}
+
+static void gpu_blend(lv_disp_drv_t* /*disp_drv*/, lv_color_t* dest, const lv_color_t* src, uint32_t length, lv_opa_t opa) {
+  if (opa >= LV_OPA_MAX) {
+    std::memcpy(dest, src, length * sizeof(lv_color_t));
+    return;
+  }
+
+  if (length > 0 && (reinterpret_cast<uintptr_t>(dest) & 0x03) != 0) {
+    *dest = lv_color_mix(*src, *dest, opa);
+    dest++;
+    src++;
+    length--;
+  }
+
+  auto* dest32 = reinterpret_cast<uint32_t*>(dest);
+  for (; length >= 2; length -= 2) {
+    // Unaligned word load. std::memcpy would be a library call, the firmware is built with -fno-builtin
+    uint32_t srcPixels;
+    __builtin_memcpy(&srcPixels, src, sizeof(srcPixels));
+    *dest32 = BlendPixelPair(srcPixels, *dest32, opa);
+    dest32++;
+    src += 2;
+  }
+
+  if (length > 0) {
+    dest = reinterpret_cast<lv_color_t*>(dest32);
+    *dest = lv_color_mix(*src, *dest, opa);
+  }
 }
 
 bool touchpad_read(lv_indev_drv_t* indev_drv, lv_indev_data_t* data) {
@@ -73,19 +243,22 @@ bool touchpad_read(lv_indev_drv_t* indev_drv, lv_indev_data_t* data) {
   return lvgl->GetTouchPadInfo(data);
 }
 
-LittleVgl::LittleVgl(Pinetime::Drivers::St7789& lcd, Pinetime::Controllers::FS& filesystem) : lcd {lcd}, filesystem {filesystem} {
+LittleVgl::LittleVgl(Pinetime::Drivers::St7789& lcd, Pinetime::Controllers::FS& filesystem)
+  : lcd {lcd}, filesystem {filesystem}, transition {lcd} {
 }
 
 void LittleVgl::Init() {
+  Utility::CycleCounter::Enable();
   lv_init();
   InitFileSystem();
+  RleImageDecoder::Register();
   InitTheme(&filesystem);
   InitDisplay();
   InitTouchpad();
 }
 
 void LittleVgl::InitDisplay() {
-  lv_disp_buf_init(&disp_buf_2, buf2_1, buf2_2, LV_HOR_RES_MAX * 4); /*Initialize the display buffer*/
+  lv_disp_buf_init(&disp_buf_2, buf2_1, buf2_2, LV_HOR_RES_MAX * nbWriteLines); /*Initialize the display buffer*/
   lv_disp_drv_init(&disp_drv);                                       /*Basic initialization*/
 
   /*Set up the functions to access to your display*/
@@ -100,11 +273,50 @@ void LittleVgl::InitDisplay() {
   disp_drv.buffer = &disp_buf_2;
   disp_drv.user_data = this;
   disp_drv.rounder_cb = rounder;
+  disp_drv.monitor_cb = monitor;
+  /*Solid fills already use the word-wide lv_color_fill(), only blending needs a faster path*/
+  disp_drv.gpu_blend_cb = gpu_blend;
 
   /*Finally register the driver*/
   lv_disp_drv_register(&disp_drv);
 }
 
+void LittleVgl::SetRenderBufferLines(uint8_t maxLines) {
+  if (maxLines == renderBufferLines) {
+    return;
+  }
+
+  FreeRenderBuffers();
+  for (uint8_t lines : largeRenderBufferLines) {
+    const size_t bufferSize = LV_HOR_RES_MAX * lines * sizeof(lv_color_t);
+    if (lines > maxLines || xPortGetFreeHeapSize() < (2 * bufferSize) + renderBufferHeapReserve) {
+      continue;
+    }
+    heapBuf1 = static_cast<lv_color_t*>(pvPortMalloc(bufferSize));
+    heapBuf2 = static_cast<lv_color_t*>(pvPortMalloc(bufferSize));
+    if (heapBuf1 != nullptr && heapBuf2 != nullptr) {
+      renderBufferLines = lines;
+      lv_disp_buf_init(&disp_buf_2, heapBuf1, heapBuf2, LV_HOR_RES_MAX * renderBufferLines);
+      return;
+    }
+    // Not enough contiguous memory
+    FreeRenderBuffers();
+  }
+}
+
+void LittleVgl::FreeRenderBuffers() {
+  if (heapBuf1 != nullptr || heapBuf2 != nullptr) {
+    // The last flushed block may still be sent to the display
+    lcd.WaitForTransfer();
+    vPortFree(heapBuf1);
+    vPortFree(heapBuf2);
+    heapBuf1 = nullptr;
+    heapBuf2 = nullptr;
+  }
+  renderBufferLines = nbWriteLines;
+  lv_disp_buf_init(&disp_buf_2, buf2_1, buf2_2, LV_HOR_RES_MAX * nbWriteLines);
+}
+
 void LittleVgl::InitTouchpad() {
   lv_indev_drv_t indev_drv;
 
@@ -129,90 +341,117 @@ void LittleVgl::InitFileSystem() {
   fs_drv.user_data = &filesystem;
 
   lv_fs_drv_register(&fs_drv);
+
+  lv_fs_drv_t resource_drv;
+  lv_fs_drv_init(&resource_drv);
+
+  resource_drv.file_size = sizeof(ResourceFile);
+  resource_drv.letter = 'R';
+  resource_drv.open_cb = resourceOpen;
+  resource_drv.close_cb = resourceClose;
+  resource_drv.read_cb = resourceRead;
+  resource_drv.seek_cb = resourceSeek;
+
+  resource_drv.user_data = &filesystem;
+
+  lv_fs_drv_register(&resource_drv);
 }
 
 void LittleVgl::SetFullRefresh(FullRefreshDirections direction) {
-  if (scrollDirection == FullRefreshDirections::None) {
-    scrollDirection = direction;
-    if (scrollDirection == FullRefreshDirections::Down) {
-      lv_disp_set_direction(lv_disp_get_default(), 1);
-    } else if (scrollDirection == FullRefreshDirections::Right) {
-      lv_disp_set_direction(lv_disp_get_default(), 2);
-    } else if (scrollDirection == FullRefreshDirections::Left) {
-      lv_disp_set_direction(lv_disp_get_default(), 3);
-    } else if (scrollDirection == FullRefreshDirections::RightAnim) {
-      lv_disp_set_direction(lv_disp_get_default(), 5);
-    } else if (scrollDirection == FullRefreshDirections::LeftAnim) {
-      lv_disp_set_direction(lv_disp_get_default(), 4);
-    }
-  }
+  transition.Start(direction);
   fullRefresh = true;
 }
 
 bool LittleVgl::IsScrolling() {
-  return scrollDirection != LittleVgl::FullRefreshDirections::None;
+  return transition.IsRunning();
 }
 
-void LittleVgl::FlushDisplay(const lv_area_t* area, lv_color_t* color_p) {
-  uint16_t y1, y2, width, height = 0;
-
-  if ((scrollDirection == LittleVgl::FullRefreshDirections::Down) && (area->y2 == visibleNbLines - 1)) {
-    writeOffset = ((writeOffset + totalNbLines) - visibleNbLines) % totalNbLines;
-  } else if ((scrollDirection == FullRefreshDirections::Up) && (area->y1 == 0)) {
-    writeOffset = (writeOffset + visibleNbLines) % totalNbLines;
+void LittleVgl::SetPartialBand(lv_coord_t y, lv_coord_t height) {
+  ClearPartialBand();
+  bandY = y;
+  bandHeight = height;
+  // Without the hashes every flushed area is sent, which is still correct
+  bandLineHashes = static_cast<uint32_t*>(pvPortMalloc(bandHeight * sizeof(uint32_t)));
+  if (bandLineHashes != nullptr) {
+    std::memset(bandLineHashes, 0, bandHeight * sizeof(uint32_t));
   }
+}
 
-  y1 = (area->y1 + writeOffset) % totalNbLines;
-  y2 = (area->y2 + writeOffset) % totalNbLines;
-
-  width = (area->x2 - area->x1) + 1;
-  height = (area->y2 - area->y1) + 1;
+void LittleVgl::ClearPartialBand() {
+  if (bandHeight == 0) {
+    return;
+  }
+  vPortFree(bandLineHashes);
+  bandLineHashes = nullptr;
+  bandHeight = 0;
+  // The lines outside of the band were not rendered while it was set
+  lv_obj_invalidate(lv_scr_act());
+}
 
-  if (scrollDirection == LittleVgl::FullRefreshDirections::Down) {
+void LittleVgl::ClipToPartialBand(lv_area_t* area) const {
+  const lv_coord_t bandY2 = bandY + bandHeight - 1;
+  if (area->y2 < bandY || area->y1 > bandY2) {
+    // LVGL can't drop an invalidated area, shrink it to a single line of the band.
+    // That line is not sent again if its content didn't change.
+    area->y1 = bandY;
+    area->y2 = bandY;
+    return;
+  }
+  area->y1 = std::max(area->y1, bandY);
+  area->y2 = std::min(area->y2, bandY2);
+}
 
-    if (area->y2 < visibleNbLines - 1) {
-      uint16_t toScroll = 0;
-      if (area->y1 == 0) {
-        toScroll = height * 2;
-        scrollDirection = FullRefreshDirections::None;
-        lv_disp_set_direction(lv_disp_get_default(), 0);
-      } else {
-        toScroll = height;
-      }
+bool LittleVgl::IsBandAreaUnchanged(const lv_area_t* area, const lv_color_t* color_p) {
+  if (bandLineHashes == nullptr || area->y1 < bandY || area->y2 >= bandY + bandHeight) {
+    return false;
+  }
 
-      if (scrollOffset >= toScroll)
-        scrollOffset -= toScroll;
-      else {
-        toScroll -= scrollOffset;
-        scrollOffset = (totalNbLines) -toScroll;
-      }
-      lcd.VerticalScrollStartAddress(scrollOffset);
+  const lv_coord_t width = (area->x2 - area->x1) + 1;
+  bool unchanged = true;
+  for (lv_coord_t y = area->y1; y <= area->y2; y++) {
+    // FNV-1a over the pixels of the line, seeded with its horizontal position.
+    // 0 is reserved for lines that were never sent.
+    uint32_t hash = 2166136261u ^ ((static_cast<uint32_t>(area->x1) << 16) | static_cast<uint32_t>(area->x2));
+    for (lv_coord_t x = 0; x < width; x++) {
+      hash = (hash ^ color_p->full) * 16777619u;
+      color_p++;
     }
+    hash |= 1;
 
-  } else if (scrollDirection == FullRefreshDirections::Up) {
-
-    if (area->y1 > 0) {
-      if (area->y2 == visibleNbLines - 1) {
-        scrollOffset += (height * 2);
-        scrollDirection = FullRefreshDirections::None;
-        lv_disp_set_direction(lv_disp_get_default(), 0);
-      } else {
-        scrollOffset += height;
-      }
-      scrollOffset = scrollOffset % totalNbLines;
-      lcd.VerticalScrollStartAddress(scrollOffset);
-    }
-  } else if (scrollDirection == FullRefreshDirections::Left or scrollDirection == FullRefreshDirections::LeftAnim) {
-    if (area->x2 == visibleNbLines - 1) {
-      scrollDirection = FullRefreshDirections::None;
-      lv_disp_set_direction(lv_disp_get_default(), 0);
-    }
-  } else if (scrollDirection == FullRefreshDirections::Right or scrollDirection == FullRefreshDirections::RightAnim) {
-    if (area->x1 == 0) {
-      scrollDirection = FullRefreshDirections::None;
-      lv_disp_set_direction(lv_disp_get_default(), 0);
+    uint32_t& lineHash = bandLineHashes[y - bandY];
+    if (lineHash != hash) {
+      lineHash = hash;
+      unchanged = false;
     }
   }
+  return unchanged;
+}
+
+void LittleVgl::FlushDisplay(const lv_area_t* area, lv_color_t* color_p) {
+  const uint32_t startCycles = Utility::CycleCounter::Now();
+  const Pinetime::Drivers::St7789::Statistics startSpi = lcd.GetStatistics();
+  if (currentFrame.areas == 0) {
+    frameStartCycles = startCycles;
+  } else {
+    currentFrame.renderCycles += startCycles - lastFlushEndCycles;
+  }
+  if (HasPartialBand() && IsBandAreaUnchanged(area, color_p)) {
+    currentFrame.areas++;
+    currentFrame.skippedAreas++;
+    lastFlushEndCycles = Utility::CycleCounter::Now();
+    currentFrame.flushCycles += lastFlushEndCycles - startCycles;
+    lv_disp_flush_ready(&disp_drv);
+    return;
+  }
+
+  uint16_t y1, y2, width, height = 0;
+
+  constexpr uint16_t totalNbLines = ScreenTransition::totalNbLines;
+  y1 = transition.OnFlush(area);
+  y2 = (y1 + (area->y2 - area->y1)) % totalNbLines;
+
+  width = (area->x2 - area->x1) + 1;
+  height = (area->y2 - area->y1) + 1;
 
   if (y2 < y1) {
     height = totalNbLines - y1;
@@ -229,11 +468,49 @@ void LittleVgl::FlushDisplay(const lv_area_t* area, lv_color_t* color_p) {
     lcd.DrawBuffer(area->x1, y1, width, height, reinterpret_cast<const uint8_t*>(color_p), width * height * 2);
   }
 
+  const Pinetime::Drivers::St7789::Statistics& endSpi = lcd.GetStatistics();
+  currentFrame.areas++;
+  currentFrame.spiTransactions += endSpi.transactions - startSpi.transactions;
+  currentFrame.spiBytes += endSpi.bytes - startSpi.bytes;
+  currentFrame.addressWindows += endSpi.addressWindows - startSpi.addressWindows;
+  lastFlushEndCycles = Utility::CycleCounter::Now();
+  currentFrame.flushCycles += lastFlushEndCycles - startCycles;
+
   // IMPORTANT!!!
   // Inform the graphics library that you are ready with the flushing
+  // The pixel data is still being sent by SpiMaster at this point: LVGL renders the next block into
+  // the other buffer meanwhile, and the next DrawBuffer() waits for this transfer to complete
+  // before touching the bus, so a buffer is never reused while it is being sent.
   lv_disp_flush_ready(&disp_drv);
 }
 
+void LittleVgl::OnRefreshDone(uint32_t time, uint32_t pixels) {
+  currentFrame.pixels = pixels;
+  currentFrame.refreshTimeMs = time;
+  currentFrame.renderBufferLines = renderBufferLines;
+  if (currentFrame.areas > 0) {
+    currentFrame.frameCycles = Utility::CycleCounter::Now() - frameStartCycles;
+  }
+  lastFrame = currentFrame;
+  currentFrame = {};
+  frameCount++;
+
+  // Only log full screen redraws (screen transitions), logging every frame would flood the log
+  if (pixels >= LV_HOR_RES_MAX * LV_VER_RES_MAX) {
+    NRF_LOG_INFO("[LVGL] Frame: %d lines buffer, %d areas, %d windows, %d SPI transactions, %d bytes",
+                 lastFrame.renderBufferLines,
+                 lastFrame.areas,
+                 lastFrame.addressWindows,
+                 lastFrame.spiTransactions,
+                 lastFrame.spiBytes);
+    NRF_LOG_INFO("[LVGL] Frame: render %dus, flush %dus, total %dus, refresh %dms",
+                 Utility::CycleCounter::ToMicroseconds(lastFrame.renderCycles),
+                 Utility::CycleCounter::ToMicroseconds(lastFrame.flushCycles),
+                 Utility::CycleCounter::ToMicroseconds(lastFrame.frameCycles),
+                 lastFrame.refreshTimeMs);
+  }
+}
+
 void LittleVgl::SetNewTouchPoint(int16_t x, int16_t y, bool contact) {
   if (contact) {
     if (!isCancelled) {
@@ -2,6 +2,7 @@
 
 #include <lvgl/lvgl.h>
 #include <components/fs/FS.h>
+#include "displayapp/ScreenTransition.h"
 
 namespace Pinetime {
   namespace Drivers {
@@ -11,7 +12,25 @@ namespace Pinetime {
   namespace Components {
     class LittleVgl {
     public:
-      enum class FullRefreshDirections { None, Up, Down, Left, Right, LeftAnim, RightAnim };
+      using FullRefreshDirections = ScreenTransition::Directions;
+
+      // Cost of one LVGL refresh cycle, from the first flushed area to the end of the refresh.
+      // flushCycles is the time spent in FlushDisplay, mostly waiting for the previous transfer to complete,
+      // renderCycles the time LVGL spent rendering between two flushes while the SPI transfer was running.
+      struct FrameStatistics {
+        uint32_t areas = 0;
+        uint32_t skippedAreas = 0;
+        uint32_t pixels = 0;
+        uint32_t spiTransactions = 0;
+        uint32_t spiBytes = 0;
+        uint32_t addressWindows = 0;
+        uint32_t flushCycles = 0;
+        uint32_t renderCycles = 0;
+        uint32_t frameCycles = 0;
+        uint32_t refreshTimeMs = 0;
+        uint8_t renderBufferLines = 0;
+      };
+
       LittleVgl(Pinetime::Drivers::St7789& lcd, Pinetime::Controllers::FS& filesystem);
 
       LittleVgl(const LittleVgl&) = delete;
@@ -21,7 +40,29 @@ namespace Pinetime {
 
       void Init();
 
+      // Render buffers taller than the default 4 lines are allocated on the heap, as long as
+      // enough heap is left for the screen. The largest of 24, 16 and 8 lines not above maxLines is used.
+      void SetRenderBufferLines(uint8_t maxLines);
+      // Goes back to the default render buffers, and frees the heap used by larger ones
+      void FreeRenderBuffers();
+
+      uint8_t GetRenderBufferLines() const {
+        return renderBufferLines;
+      }
+
+      // Restricts rendering to the lines y to y + height - 1, used with the partial mode of the display.
+      // Flushed areas whose content did not change since they were last sent are not sent again.
+      void SetPartialBand(lv_coord_t y, lv_coord_t height);
+      void ClearPartialBand();
+
+      bool HasPartialBand() const {
+        return bandHeight > 0;
+      }
+
+      void ClipToPartialBand(lv_area_t* area) const;
+
       void FlushDisplay(const lv_area_t* area, lv_color_t* color_p);
+      void OnRefreshDone(uint32_t time, uint32_t pixels);
       bool GetTouchPadInfo(lv_indev_data_t* ptr);
       void SetFullRefresh(FullRefreshDirections direction);
       void SetNewTouchPoint(int16_t x, int16_t y, bool contact);
@@ -37,10 +78,19 @@ namespace Pinetime {
         return returnValue;
       }
 
+      const FrameStatistics& GetLastFrameStatistics() const {
+        return lastFrame;
+      }
+
+      uint32_t GetFrameCount() const {
+        return frameCount;
+      }
+
     private:
       void InitDisplay();
       void InitTouchpad();
       void InitFileSystem();
+      bool IsBandAreaUnchanged(const lv_area_t* area, const lv_color_t* color_p);
 
       Pinetime::Drivers::St7789& lcd;
       Pinetime::Controllers::FS& filesystem;
@@ -48,25 +98,35 @@ namespace Pinetime {
       lv_disp_buf_t disp_buf_2;
       lv_color_t buf2_1[LV_HOR_RES_MAX * 4];
       lv_color_t buf2_2[LV_HOR_RES_MAX * 4];
+      lv_color_t* heapBuf1 = nullptr;
+      lv_color_t* heapBuf2 = nullptr;
 
       lv_disp_drv_t disp_drv;
 
       bool fullRefresh = false;
       static constexpr uint8_t nbWriteLines = 4;
-      static constexpr uint16_t totalNbLines = 320;
-      static constexpr uint16_t visibleNbLines = 240;
 
-      static constexpr uint8_t MaxScrollOffset() {
-        return LV_VER_RES_MAX - nbWriteLines;
-      }
+      static constexpr uint8_t largeRenderBufferLines[] = {24, 16, 8};
+      // Heap that must remain available to LVGL and the other tasks after allocating large render buffers
+      static constexpr size_t renderBufferHeapReserve = 8 * 1024;
+      uint8_t renderBufferLines = nbWriteLines;
 
-      FullRefreshDirections scrollDirection = FullRefreshDirections::None;
-      uint16_t writeOffset = 0;
-      uint16_t scrollOffset = 0;
+      ScreenTransition transition;
+
+      lv_coord_t bandY = 0;
+      lv_coord_t bandHeight = 0;
+      // Hash of the last content sent for each line of the band
+      uint32_t* bandLineHashes = nullptr;
 
       lv_point_t touchPoint = {};
       bool tapped = false;
       bool isCancelled = false;
+
+      FrameStatistics currentFrame;
+      FrameStatistics lastFrame;
+      uint32_t frameStartCycles = 0;
+      uint32_t lastFlushEndCycles = 0;
+      uint32_t frameCount = 0;
     };
   }
 }
@@ -24,6 +24,8 @@ namespace Pinetime {
         AlarmTriggered,
         Chime,
         BleRadioEnableToggle,
+        // A value shown by the current screen changed, see Controllers::ChangeNotifier
+        StateChanged,
       };
     }
   }
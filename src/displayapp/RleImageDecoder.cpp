@@ -0,0 +1,113 @@
+#include "displayapp/RleImageDecoder.h"
+#include <new>
+#include "components/rle/PaletteRleDecoder.h"
+
+using namespace Pinetime::Components;
+
+// The colour format is written by tools/rle_encode.py
+static_assert(LV_IMG_CF_USER_ENCODED_0 == 24);
+
+namespace {
+  struct RleImage {
+    explicit RleImage(const lv_img_dsc_t* image) : decoder {image->data, image->data_size, static_cast<uint16_t>(image->header.w)} {
+    }
+
+    explicit RleImage(uint16_t width);
+
+    lv_fs_file_t file;
+    bool fileOpened = false;
+    Pinetime::Tools::PaletteRleDecoder decoder;
+  };
+
+  int ReadFile(void* context, uint32_t offset, uint8_t* buffer, uint32_t size) {
+    auto* image = static_cast<RleImage*>(context);
+    uint32_t read = 0;
+    if (lv_fs_seek(&image->file, sizeof(lv_img_header_t) + offset) != LV_FS_RES_OK ||
+        lv_fs_read(&image->file, buffer, size, &read) != LV_FS_RES_OK) {
+      return -1;
+    }
+    return read;
+  }
+
+  RleImage::RleImage(uint16_t width) : decoder {ReadFile, this, width} {
+  }
+}
+
+void RleImageDecoder::Register() {
+  lv_img_decoder_t* decoder = lv_img_decoder_create();
+  lv_img_decoder_set_info_cb(decoder, Info);
+  lv_img_decoder_set_open_cb(decoder, Open);
+  lv_img_decoder_set_read_line_cb(decoder, ReadLine);
+  lv_img_decoder_set_close_cb(decoder, Close);
+}
+
+lv_res_t RleImageDecoder::Info(lv_img_decoder_t* /*decoder*/, const void* source, lv_img_header_t* header) {
+  switch (lv_img_src_get_type(source)) {
+    case LV_IMG_SRC_VARIABLE:
+      *header = static_cast<const lv_img_dsc_t*>(source)->header;
+      break;
+    case LV_IMG_SRC_FILE: {
+      lv_fs_file_t file;
+      if (lv_fs_open(&file, static_cast<const char*>(source), LV_FS_MODE_RD) != LV_FS_RES_OK) {
+        return LV_RES_INV;
+      }
+      uint32_t read = 0;
+      const lv_fs_res_t res = lv_fs_read(&file, header, sizeof(lv_img_header_t), &read);
+      lv_fs_close(&file);
+      if (res != LV_FS_RES_OK || read != sizeof(lv_img_header_t)) {
+        return LV_RES_INV;
+      }
+      break;
+    }
+    default:
+      return LV_RES_INV;
+  }
+  return (header->cf == colorFormat) ? LV_RES_OK : LV_RES_INV;
+}
+
+lv_res_t RleImageDecoder::Open(lv_img_decoder_t* /*decoder*/, lv_img_decoder_dsc_t* descriptor) {
+  RleImage* image;
+  if (descriptor->src_type == LV_IMG_SRC_VARIABLE) {
+    image = new (std::nothrow) RleImage(static_cast<const lv_img_dsc_t*>(descriptor->src));
+  } else {
+    image = new (std::nothrow) RleImage(descriptor->header.w);
+  }
+  // Like the R: driver, the image is not opened when the heap is exhausted
+  if (image == nullptr) {
+    return LV_RES_INV;
+  }
+  if (descriptor->src_type == LV_IMG_SRC_FILE) {
+    image->fileOpened = lv_fs_open(&image->file, static_cast<const char*>(descriptor->src), LV_FS_MODE_RD) == LV_FS_RES_OK;
+  }
+  descriptor->user_data = image;
+
+  if ((descriptor->src_type == LV_IMG_SRC_FILE && !image->fileOpened) || !image->decoder.Init()) {
+    Close(nullptr, descriptor);
+    return LV_RES_INV;
+  }
+  // No img_data: LVGL reads the image line by line
+  descriptor->img_data = nullptr;
+  return LV_RES_OK;
+}
+
+lv_res_t RleImageDecoder::ReadLine(lv_img_decoder_t* /*decoder*/,
+                                   lv_img_decoder_dsc_t* descriptor,
+                                   lv_coord_t x,
+                                   lv_coord_t y,
+                                   lv_coord_t length,
+                                   uint8_t* buffer) {
+  auto* image = static_cast<RleImage*>(descriptor->user_data);
+  return image->decoder.DecodeLine(y, x, length, buffer) ? LV_RES_OK : LV_RES_INV;
+}
+
+void RleImageDecoder::Close(lv_img_decoder_t* /*decoder*/, lv_img_decoder_dsc_t* descriptor) {
+  auto* image = static_cast<RleImage*>(descriptor->user_data);
+  if (image == nullptr) {
+    return;
+  }
+  if (image->fileOpened) {
+    lv_fs_close(&image->file);
+  }
+  delete image;
+  descriptor->user_data = nullptr;
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <lvgl/lvgl.h>
+
+namespace Pinetime {
+  namespace Components {
+    // LVGL image decoder for the palette RLE images generated by tools/rle_encode.py --lvgl
+    // (see components/rle/PaletteRleDecoder.h), identified by the colour format LV_IMG_CF_USER_ENCODED_0.
+    // The images can be C arrays (lv_img_dsc_t) or files ("R:/images/background.bin").
+    // LVGL reads them line by line, the runs are decoded directly into its buffers.
+    class RleImageDecoder {
+    public:
+      static constexpr lv_img_cf_t colorFormat = LV_IMG_CF_USER_ENCODED_0;
+
+      static void Register();
+
+    private:
+      static lv_res_t Info(lv_img_decoder_t* decoder, const void* source, lv_img_header_t* header);
+      static lv_res_t Open(lv_img_decoder_t* decoder, lv_img_decoder_dsc_t* descriptor);
+      static lv_res_t
+      ReadLine(lv_img_decoder_t* decoder, lv_img_decoder_dsc_t* descriptor, lv_coord_t x, lv_coord_t y, lv_coord_t length, uint8_t* buffer);
+      static void Close(lv_img_decoder_t* decoder, lv_img_decoder_dsc_t* descriptor);
+    };
+  }
+}
@@ -0,0 +1,83 @@
+#include "displayapp/ScreenCache.h"
+
+#include <FreeRTOS.h>
+#include <libraries/log/nrf_log.h>
+
+using namespace Pinetime::Applications;
+
+void ScreenCache::Store(Apps app, std::unique_ptr<Screens::Screen> screen, lv_obj_t* lvScreen) {
+  Entry* entry = nullptr;
+  for (auto& e : entries) {
+    if (e.app == app || (entry == nullptr && e.app == Apps::None)) {
+      entry = &e;
+    }
+  }
+  if (entry == nullptr) {
+    entry = LeastRecentlyUsed();
+  }
+  if (entry->app != Apps::None) {
+    Evict(*entry);
+  }
+
+  entry->app = app;
+  entry->screen = std::move(screen);
+  entry->lvScreen = lvScreen;
+  entry->lastUse = ++useCount;
+}
+
+std::unique_ptr<Pinetime::Applications::Screens::Screen> ScreenCache::Restore(Apps app) {
+  for (auto& entry : entries) {
+    if (entry.app != app) {
+      continue;
+    }
+
+    lv_obj_t* unused = lv_scr_act();
+    lv_scr_load(entry.lvScreen);
+    lv_obj_del(unused);
+
+    std::unique_ptr<Screens::Screen> screen = std::move(entry.screen);
+    entry = {};
+    NRF_LOG_INFO("[ScreenCache] Restored app %d", static_cast<uint8_t>(app));
+    return screen;
+  }
+  return nullptr;
+}
+
+void ScreenCache::Shrink(size_t minFreeHeap) {
+  while (xPortGetFreeHeapSize() < minFreeHeap) {
+    Entry* entry = LeastRecentlyUsed();
+    if (entry == nullptr) {
+      return;
+    }
+    NRF_LOG_INFO("[ScreenCache] Low heap (%d bytes), evicting app %d", xPortGetFreeHeapSize(), static_cast<uint8_t>(entry->app));
+    Evict(*entry);
+  }
+}
+
+void ScreenCache::Clear() {
+  for (auto& entry : entries) {
+    if (entry.app != Apps::None) {
+      Evict(entry);
+    }
+  }
+}
+
+void ScreenCache::Evict(Entry& entry) {
+  // Screens delete the objects of the active LVGL screen when they are destroyed
+  lv_obj_t* active = lv_scr_act();
+  lv_scr_load(entry.lvScreen);
+  entry.screen.reset();
+  lv_scr_load(active);
+  lv_obj_del(entry.lvScreen);
+  entry = {};
+}
+
+ScreenCache::Entry* ScreenCache::LeastRecentlyUsed() {
+  Entry* lru = nullptr;
+  for (auto& entry : entries) {
+    if (entry.app != Apps::None && (lru == nullptr || entry.lastUse < lru->lastUse)) {
+      lru = &entry;
+    }
+  }
+  return lru;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <lvgl/lvgl.h>
+#include "displayapp/apps/Apps.h"
+#include "displayapp/screens/Screen.h"
+
+namespace Pinetime {
+  namespace Applications {
+    // Keeps the screens the user returns to the most (the watch face and the launcher) alive while another app is
+    // shown, so that going back to them doesn't rebuild their whole object tree and reload their fonts.
+    // Each cached screen keeps its own LVGL screen. Cached screens are destroyed, least recently used first,
+    // when the heap runs low.
+    class ScreenCache {
+    public:
+      static bool IsCacheable(Apps app) {
+        return app == Apps::Clock || app == Apps::Launcher;
+      }
+
+      // lvScreen is the LVGL screen holding the objects of screen, the caller loads another LVGL screen afterwards
+      void Store(Apps app, std::unique_ptr<Screens::Screen> screen, lv_obj_t* lvScreen);
+
+      // Shows the LVGL screen of the cached app and returns its screen, or nullptr if it isn't cached.
+      // The LVGL screen that was active must be empty, it is deleted.
+      std::unique_ptr<Screens::Screen> Restore(Apps app);
+
+      // Destroys cached screens until at least minFreeHeap bytes of heap are free
+      void Shrink(size_t minFreeHeap);
+
+      void Clear();
+
+    private:
+      struct Entry {
+        Apps app = Apps::None;
+        std::unique_ptr<Screens::Screen> screen;
+        lv_obj_t* lvScreen = nullptr;
+        uint32_t lastUse = 0;
+      };
+
+      void Evict(Entry& entry);
+      Entry* LeastRecentlyUsed();
+
+      std::array<Entry, 2> entries;
+      uint32_t useCount = 0;
+    };
+  }
+}
@@ -0,0 +1,111 @@
+#include "displayapp/ScreenTransition.h"
+#include "drivers/St7789.h"
+
+using namespace Pinetime::Components;
+
+ScreenTransition::ScreenTransition(Pinetime::Drivers::St7789& lcd) : lcd {lcd} {
+}
+
+void ScreenTransition::Start(Directions newDirection) {
+  if (direction != Directions::None) {
+    return;
+  }
+
+  direction = newDirection;
+  switch (direction) {
+    case Directions::Down:
+      lv_disp_set_direction(lv_disp_get_default(), 1);
+      break;
+    case Directions::Right:
+      lv_disp_set_direction(lv_disp_get_default(), 2);
+      break;
+    case Directions::Left:
+      lv_disp_set_direction(lv_disp_get_default(), 3);
+      break;
+    case Directions::RightAnim:
+      lv_disp_set_direction(lv_disp_get_default(), 5);
+      break;
+    case Directions::LeftAnim:
+      lv_disp_set_direction(lv_disp_get_default(), 4);
+      break;
+    default:
+      break;
+  }
+}
+
+uint16_t ScreenTransition::OnFlush(const lv_area_t* area) {
+  if ((direction == Directions::Down) && (area->y2 == visibleNbLines - 1)) {
+    writeOffset = ((writeOffset + totalNbLines) - visibleNbLines) % totalNbLines;
+  } else if ((direction == Directions::Up) && (area->y1 == 0)) {
+    writeOffset = (writeOffset + visibleNbLines) % totalNbLines;
+  }
+
+  switch (direction) {
+    case Directions::Down:
+      ScrollDown(area);
+      break;
+    case Directions::Up:
+      ScrollUp(area);
+      break;
+    case Directions::Left:
+    case Directions::LeftAnim:
+      if (area->x2 == visibleNbLines - 1) {
+        End();
+      }
+      break;
+    case Directions::Right:
+    case Directions::RightAnim:
+      if (area->x1 == 0) {
+        End();
+      }
+      break;
+    default:
+      break;
+  }
+
+  return (area->y1 + writeOffset) % totalNbLines;
+}
+
+void ScreenTransition::ScrollDown(const lv_area_t* area) {
+  if (area->y2 >= visibleNbLines - 1) {
+    return;
+  }
+
+  const uint16_t height = (area->y2 - area->y1) + 1;
+  uint16_t toScroll = 0;
+  if (area->y1 == 0) {
+    toScroll = height * 2;
+    End();
+  } else {
+    toScroll = height;
+  }
+
+  if (scrollOffset >= toScroll) {
+    scrollOffset -= toScroll;
+  } else {
+    toScroll -= scrollOffset;
+    scrollOffset = totalNbLines - toScroll;
+  }
+  lcd.VerticalScrollStartAddress(scrollOffset);
+}
+
+void ScreenTransition::ScrollUp(const lv_area_t* area) {
+  if (area->y1 == 0) {
+    return;
+  }
+
+  const uint16_t height = (area->y2 - area->y1) + 1;
+  if (area->y2 == visibleNbLines - 1) {
+    scrollOffset += (height * 2);
+    End();
+  } else {
+    scrollOffset += height;
+  }
+  scrollOffset = scrollOffset % totalNbLines;
+  lcd.VerticalScrollStartAddress(scrollOffset);
+}
+
+void ScreenTransition::End() {
+  direction = Directions::None;
+  lv_disp_set_direction(lv_disp_get_default(), 0);
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+#include <lvgl/lvgl.h>
+
+namespace Pinetime {
+  namespace Drivers {
+    class St7789;
+  }
+
+  namespace Components {
+    // Animates full screen refreshes.
+    // Vertical transitions use the hardware scrolling of the ST7789: its GRAM is 320 lines high, so the new screen
+    // is written to the lines that are scrolled out of the 240 visible ones while the display scrolls.
+    // The controller cannot scroll horizontally, horizontal transitions only change the order in which LVGL
+    // renders the new screen.
+    class ScreenTransition {
+    public:
+      enum class Directions { None, Up, Down, Left, Right, LeftAnim, RightAnim };
+
+      explicit ScreenTransition(Pinetime::Drivers::St7789& lcd);
+
+      void Start(Directions direction);
+
+      bool IsRunning() const {
+        return direction != Directions::None;
+      }
+
+      // Scrolls the display for the area about to be flushed, and returns the GRAM line its first line is written to
+      uint16_t OnFlush(const lv_area_t* area);
+
+      static constexpr uint16_t totalNbLines = 320;
+      static constexpr uint16_t visibleNbLines = 240;
+
+    private:
+      void ScrollDown(const lv_area_t* area);
+      void ScrollUp(const lv_area_t* area);
+      void End();
+
+      Pinetime::Drivers::St7789& lcd;
+
+      Directions direction = Directions::None;
+      uint16_t writeOffset = 0;
+      uint16_t scrollOffset = 0;
+    };
+  }
+}
@@ -0,0 +1,413 @@
+#include "displayapp/StreamingFont.h"
+
+#include <cstring>
+#include <FreeRTOS.h>
+#include <libraries/log/nrf_log.h>
+#include "components/fs/FS.h"
+
+using namespace Pinetime::Components;
+
+namespace {
+  // Layout of the "head" section, as written by lv_font_conv
+  struct FontHeader {
+    uint32_t version;
+    uint16_t tablesCount;
+    uint16_t fontSize;
+    uint16_t ascent;
+    int16_t descent;
+    uint16_t typoAscent;
+    int16_t typoDescent;
+    uint16_t typoLineGap;
+    int16_t minY;
+    int16_t maxY;
+    uint16_t defaultAdvanceWidth;
+    uint16_t kerningScale;
+    uint8_t indexToLocFormat;
+    uint8_t glyphIdFormat;
+    uint8_t advanceWidthFormat;
+    uint8_t bitsPerPixel;
+    uint8_t xyBits;
+    uint8_t whBits;
+    uint8_t advanceWidthBits;
+    uint8_t compressionId;
+    uint8_t subpixelsMode;
+    uint8_t padding;
+  };
+
+  constexpr size_t sectionLabelSize = 8;
+  constexpr size_t cmapTableSize = 16;
+  // Enough for the fields of a glyph descriptor, whatever their size
+  constexpr size_t maxGlyphHeaderSize = 8;
+
+  uint16_t ReadUint16(const uint8_t* data, size_t index) {
+    uint16_t value;
+    std::memcpy(&value, data + (index * sizeof(value)), sizeof(value));
+    return value;
+  }
+
+  class BitReader {
+  public:
+    explicit BitReader(const uint8_t* data) : data {data} {
+    }
+
+    uint32_t Read(uint8_t nbBits) {
+      uint32_t value = 0;
+      while (nbBits-- > 0) {
+        const uint8_t bit = (data[position / 8] >> (7 - (position % 8))) & 1;
+        value = (value << 1) | bit;
+        position++;
+      }
+      return value;
+    }
+
+    int32_t ReadSigned(uint8_t nbBits) {
+      const uint32_t value = Read(nbBits);
+      if (nbBits > 0 && (value & (1 << (nbBits - 1))) != 0) {
+        return static_cast<int32_t>(value) - (1 << nbBits);
+      }
+      return static_cast<int32_t>(value);
+    }
+
+  private:
+    const uint8_t* data;
+    uint32_t position = 0;
+  };
+}
+
+StreamingFont::StreamingFont(Pinetime::Controllers::FS& filesystem) : filesystem {filesystem} {
+}
+
+StreamingFont::~StreamingFont() {
+  FreeIndex();
+}
+
+bool StreamingFont::Load(const char* fontPath) {
+  FreeIndex();
+  Pinetime::Controllers::ResourceBundle::Resource resource;
+  const uint32_t generation = filesystem.Resources().Generation();
+  if (std::strlen(fontPath) < path.size() && filesystem.Resources().Find(fontPath, resource) && resource.compressedSize == 0) {
+    packed = true;
+    std::strncpy(path.data(), fontPath, path.size());
+    resourceOffset = resource.offset;
+    resourceSize = resource.size;
+    resourceGeneration = generation;
+  } else if (filesystem.FileOpen(&file, fontPath, LFS_O_RDONLY) == LFS_ERR_OK) {
+    opened = true;
+  } else {
+    return false;
+  }
+
+  // The sections of the file are head, cmap, loca, glyf and optionally kern
+  FontHeader header;
+  const uint32_t headerLength = ReadSectionLabel(0, "head");
+  if (headerLength < sectionLabelSize + sizeof(header) ||
+      Read(sectionLabelSize, reinterpret_cast<uint8_t*>(&header), sizeof(header)) != sizeof(header) || header.compressionId != 0) {
+    // Compressed bitmaps can only be decoded from the start of each glyph, they are loaded with lv_font_load()
+    FreeIndex();
+    return false;
+  }
+
+  const uint32_t cmapStart = headerLength;
+  const uint32_t cmapLength = ReadSectionLabel(cmapStart, "cmap");
+  if (cmapLength <= sectionLabelSize) {
+    FreeIndex();
+    return false;
+  }
+  cmaps = static_cast<uint8_t*>(pvPortMalloc(cmapLength));
+  if (cmaps == nullptr) {
+    FreeIndex();
+    return false;
+  }
+  indexSize += cmapLength;
+  std::memcpy(cmaps, &cmapLength, sizeof(cmapLength));
+  std::memcpy(cmaps + 4, "cmap", 4);
+  const uint32_t cmapDataLength = cmapLength - sectionLabelSize;
+  if (Read(cmapStart + sectionLabelSize, cmaps + sectionLabelSize, cmapDataLength) != static_cast<int>(cmapDataLength)) {
+    FreeIndex();
+    return false;
+  }
+  std::memcpy(&cmapsCount, cmaps + sectionLabelSize, sizeof(cmapsCount));
+
+  const uint32_t locaStart = cmapStart + cmapLength;
+  const uint32_t locaLength = ReadSectionLabel(locaStart, "loca");
+  uint32_t locaCount = 0;
+  if (locaLength <= sectionLabelSize ||
+      Read(locaStart + sectionLabelSize, reinterpret_cast<uint8_t*>(&locaCount), sizeof(locaCount)) != sizeof(locaCount) ||
+      locaCount == 0) {
+    FreeIndex();
+    return false;
+  }
+
+  glyphs = static_cast<Glyph*>(pvPortMalloc(locaCount * sizeof(Glyph)));
+  const size_t offsetSize = header.indexToLocFormat == 0 ? sizeof(uint16_t) : sizeof(uint32_t);
+  auto* offsets = static_cast<uint8_t*>(pvPortMalloc(locaCount * offsetSize));
+  if (glyphs == nullptr || offsets == nullptr ||
+      Read(locaStart + sectionLabelSize + sizeof(locaCount), offsets, locaCount * offsetSize) != static_cast<int>(locaCount * offsetSize)) {
+    vPortFree(offsets);
+    FreeIndex();
+    return false;
+  }
+  glyphsCount = locaCount;
+  indexSize += locaCount * sizeof(Glyph);
+
+  // Parse the descriptor at the beginning of each glyph, the bitmaps following them are skipped
+  const uint32_t glyfStart = locaStart + locaLength;
+  bitsPerPixel = header.bitsPerPixel;
+  headerBits = header.advanceWidthBits + (2 * header.xyBits) + (2 * header.whBits);
+  bool valid = headerBits <= maxGlyphHeaderSize * 8;
+  for (uint32_t i = 0; i < glyphsCount && valid; i++) {
+    uint32_t offset;
+    if (offsetSize == sizeof(uint16_t)) {
+      offset = ReadUint16(offsets, i);
+    } else {
+      std::memcpy(&offset, offsets + (i * sizeof(offset)), sizeof(offset));
+    }
+
+    Glyph& glyph = glyphs[i];
+    glyph = {};
+    glyph.offset = glyfStart + offset;
+    // The first glyph is reserved
+    if (i == 0) {
+      continue;
+    }
+
+    uint8_t buffer[maxGlyphHeaderSize] {};
+    valid = Read(glyph.offset, buffer, (headerBits + 7) / 8) >= 0;
+
+    BitReader reader(buffer);
+    uint32_t advanceWidth = header.advanceWidthBits == 0 ? header.defaultAdvanceWidth : reader.Read(header.advanceWidthBits);
+    if (header.advanceWidthFormat == 0) {
+      advanceWidth *= 16;
+    }
+    glyph.advanceWidth = (advanceWidth + 8) >> 4;
+    glyph.offsetX = reader.ReadSigned(header.xyBits);
+    glyph.offsetY = reader.ReadSigned(header.xyBits);
+    glyph.width = reader.Read(header.whBits);
+    glyph.height = reader.Read(header.whBits);
+  }
+  vPortFree(offsets);
+  if (!valid) {
+    FreeIndex();
+    return false;
+  }
+
+  font.get_glyph_dsc = GetGlyphDescriptor;
+  font.get_glyph_bitmap = GetGlyphBitmap;
+  font.line_height = header.maxY - header.minY;
+  font.base_line = -header.minY;
+  font.subpx = header.subpixelsMode;
+  font.dsc = this;
+  NRF_LOG_INFO("[StreamingFont] %d glyphs indexed in %d bytes", glyphsCount, indexSize);
+  return true;
+}
+
+StreamingFont* StreamingFont::FromFont(lv_font_t* font) {
+  if (font == nullptr || font->get_glyph_dsc != GetGlyphDescriptor) {
+    return nullptr;
+  }
+  return static_cast<StreamingFont*>(font->dsc);
+}
+
+bool StreamingFont::GetGlyphDescriptor(const lv_font_t* font, lv_font_glyph_dsc_t* descriptor, uint32_t letter, uint32_t /*next*/) {
+  const auto* self = static_cast<const StreamingFont*>(font->dsc);
+  const uint32_t glyphId = self->FindGlyphId(letter);
+  if (glyphId == 0 || glyphId >= self->glyphsCount) {
+    return false;
+  }
+
+  const Glyph& glyph = self->glyphs[glyphId];
+  descriptor->adv_w = glyph.advanceWidth;
+  descriptor->box_w = glyph.width;
+  descriptor->box_h = glyph.height;
+  descriptor->ofs_x = glyph.offsetX;
+  descriptor->ofs_y = glyph.offsetY;
+  descriptor->bpp = self->bitsPerPixel;
+  return true;
+}
+
+const uint8_t* StreamingFont::GetGlyphBitmap(const lv_font_t* font, uint32_t letter) {
+  auto* self = static_cast<StreamingFont*>(font->dsc);
+  const uint32_t glyphId = self->FindGlyphId(letter);
+  if (glyphId == 0 || glyphId >= self->glyphsCount) {
+    return nullptr;
+  }
+  return self->LoadBitmap(glyphId);
+}
+
+uint32_t StreamingFont::FindGlyphId(uint32_t letter) const {
+  for (uint32_t i = 0; i < cmapsCount; i++) {
+    CmapTable table;
+    std::memcpy(&table, cmaps + sectionLabelSize + sizeof(cmapsCount) + (i * cmapTableSize), sizeof(table));
+    const uint32_t codeOffset = letter - table.rangeStart;
+    if (codeOffset > table.rangeLength) {
+      continue;
+    }
+
+    const uint8_t* data = cmaps + table.dataOffset;
+    switch (table.formatType) {
+      case LV_FONT_FMT_TXT_CMAP_FORMAT0_TINY:
+        return table.glyphIdStart + codeOffset;
+      case LV_FONT_FMT_TXT_CMAP_FORMAT0_FULL:
+        return table.glyphIdStart + data[codeOffset];
+      case LV_FONT_FMT_TXT_CMAP_SPARSE_TINY:
+      case LV_FONT_FMT_TXT_CMAP_SPARSE_FULL: {
+        // The code points of sparse tables are sorted
+        int32_t low = 0;
+        int32_t high = static_cast<int32_t>(table.entriesCount) - 1;
+        while (low <= high) {
+          const int32_t middle = (low + high) / 2;
+          const uint16_t code = ReadUint16(data, middle);
+          if (code < codeOffset) {
+            low = middle + 1;
+          } else if (code > codeOffset) {
+            high = middle - 1;
+          } else if (table.formatType == LV_FONT_FMT_TXT_CMAP_SPARSE_TINY) {
+            return table.glyphIdStart + middle;
+          } else {
+            return table.glyphIdStart + ReadUint16(data, table.entriesCount + middle);
+          }
+        }
+        break;
+      }
+      default:
+        break;
+    }
+  }
+  return 0;
+}
+
+const uint8_t* StreamingFont::LoadBitmap(uint32_t glyphId) {
+  if (packed && filesystem.Resources().Generation() != resourceGeneration && !RelocateResource()) {
+    return nullptr;
+  }
+
+  CachedBitmap* slot = nullptr;
+  for (auto& cached : cache) {
+    if (cached.bitmap != nullptr && cached.glyphId == glyphId) {
+      cached.lastUse = ++useCount;
+      return cached.bitmap;
+    }
+    if (cached.bitmap == nullptr) {
+      slot = &cached;
+    }
+  }
+
+  // The bitmap follows the descriptor fields without padding, so it may start in the middle of a byte
+  const Glyph& glyph = glyphs[glyphId];
+  const uint32_t bitmapBits = static_cast<uint32_t>(glyph.width) * glyph.height * bitsPerPixel;
+  const uint8_t shift = headerBits % 8;
+  const uint16_t size = (bitmapBits + 7) / 8;
+  const uint16_t rawSize = (shift + bitmapBits + 7) / 8;
+  if (size == 0) {
+    return nullptr;
+  }
+
+  // Evict the least recently used bitmaps, the one LVGL is drawing was requested last and is kept
+  auto leastRecentlyUsed = [this]() {
+    CachedBitmap* lru = nullptr;
+    for (auto& cached : cache) {
+      if (cached.bitmap != nullptr && (lru == nullptr || cached.lastUse < lru->lastUse)) {
+        lru = &cached;
+      }
+    }
+    return lru;
+  };
+  while (slot == nullptr || (cachedSize > 0 && cachedSize + rawSize > cacheSize)) {
+    CachedBitmap* lru = leastRecentlyUsed();
+    if (lru == nullptr) {
+      break;
+    }
+    cachedSize -= lru->size;
+    vPortFree(lru->bitmap);
+    *lru = {};
+    slot = lru;
+  }
+
+  auto* bitmap = static_cast<uint8_t*>(pvPortMalloc(rawSize));
+  if (bitmap == nullptr) {
+    return nullptr;
+  }
+
+  if (Read(glyph.offset + (headerBits / 8), bitmap, rawSize) != static_cast<int>(rawSize)) {
+    vPortFree(bitmap);
+    return nullptr;
+  }
+
+  if (shift != 0) {
+    for (uint16_t i = 0; i < size; i++) {
+      const uint8_t next = (i + 1 < rawSize) ? bitmap[i + 1] : 0;
+      bitmap[i] = (bitmap[i] << shift) | (next >> (8 - shift));
+    }
+  }
+
+  slot->bitmap = bitmap;
+  slot->glyphId = glyphId;
+  slot->size = rawSize;
+  slot->lastUse = ++useCount;
+  cachedSize += rawSize;
+  return bitmap;
+}
+
+uint32_t StreamingFont::ReadSectionLabel(uint32_t offset, const char* label) {
+  uint8_t buffer[sectionLabelSize];
+  if (Read(offset, buffer, sizeof(buffer)) != sizeof(buffer) || std::memcmp(&buffer[4], label, 4) != 0) {
+    return 0;
+  }
+  uint32_t length;
+  std::memcpy(&length, buffer, sizeof(length));
+  return length;
+}
+
+bool StreamingFont::RelocateResource() {
+  // Taken before the lookup, a bundle invalidated meanwhile is looked up again on the next bitmap
+  resourceGeneration = filesystem.Resources().Generation();
+  FreeCache();
+  Pinetime::Controllers::ResourceBundle::Resource resource;
+  if (!filesystem.Resources().Find(path.data(), resource) || resource.compressedSize != 0 || resource.size != resourceSize) {
+    NRF_LOG_INFO("[StreamingFont] %s changed in the resource bundle, its glyphs aren't drawn anymore", path.data());
+    packed = false;
+    return false;
+  }
+  resourceOffset = resource.offset;
+  return true;
+}
+
+int StreamingFont::Read(uint32_t offset, uint8_t* buffer, uint32_t size) {
+  if (packed) {
+    return filesystem.Resources().Read(resourceOffset + offset, buffer, size);
+  }
+  if (!opened) {
+    return LFS_ERR_NOENT;
+  }
+  const int result = filesystem.FileSeek(&file, offset);
+  if (result < 0) {
+    return result;
+  }
+  return filesystem.FileRead(&file, buffer, size);
+}
+
+void StreamingFont::FreeCache() {
+  for (auto& cached : cache) {
+    vPortFree(cached.bitmap);
+    cached = {};
+  }
+  cachedSize = 0;
+}
+
+void StreamingFont::FreeIndex() {
+  if (opened) {
+    filesystem.FileClose(&file);
+    opened = false;
+  }
+  packed = false;
+  resourceOffset = 0;
+  FreeCache();
+  vPortFree(cmaps);
+  cmaps = nullptr;
+  cmapsCount = 0;
+  vPortFree(glyphs);
+  glyphs = nullptr;
+  glyphsCount = 0;
+  indexSize = 0;
+  font = {};
+}
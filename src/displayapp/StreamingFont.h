@@ -0,0 +1,120 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <littlefs/lfs.h>
+#include <lvgl/lvgl.h>
+#include "components/fs/ResourceBundle.h"
+
+namespace Pinetime {
+  namespace Controllers {
+    class FS;
+  }
+
+  namespace Components {
+    // LVGL binary font (lv_font_conv --format bin --no-compress) whose glyph bitmaps stay in the filesystem.
+    // Only the header, the character maps and the glyph descriptors are loaded in RAM, the bitmaps are read
+    // from the SPI flash when LVGL draws a glyph and kept in a small LRU cache of cacheSize bytes.
+    // The font is read from the resource bundle when it is stored there uncompressed, from its own file otherwise.
+    // Either file stays open while the font is loaded, so a cache miss is a seek and a read. When the bundle is
+    // replaced, the font is looked up again: it is only used if it didn't change, the index in RAM wouldn't match.
+    // Kerning isn't supported, the kerning table of the font (if any) is ignored.
+    class StreamingFont {
+    public:
+      explicit StreamingFont(Pinetime::Controllers::FS& filesystem);
+      ~StreamingFont();
+
+      StreamingFont(const StreamingFont&) = delete;
+      StreamingFont& operator=(const StreamingFont&) = delete;
+      StreamingFont(StreamingFont&&) = delete;
+      StreamingFont& operator=(StreamingFont&&) = delete;
+
+      // Loads the index of the font stored at path in the filesystem ("/fonts/bebas.bin")
+      bool Load(const char* path);
+
+      lv_font_t* GetFont() {
+        return &font;
+      }
+
+      // Heap used by the index and the glyph cache
+      size_t MemoryUsage() const {
+        return indexSize + cachedSize;
+      }
+
+      // Returns the streaming font implementing font, or nullptr if font was loaded another way
+      static StreamingFont* FromFont(lv_font_t* font);
+
+      // Enough for the glyphs of a time label ("12:34"): the digits of bebas and 7segments_115 are 750 to 860 bytes each
+      static constexpr size_t cacheSize = 5 * 1024;
+
+    private:
+      struct Glyph {
+        // Offset of the glyph in the file
+        uint32_t offset;
+        uint16_t advanceWidth;
+        uint8_t width;
+        uint8_t height;
+        int8_t offsetX;
+        int8_t offsetY;
+      };
+
+      struct CmapTable {
+        uint32_t dataOffset;
+        uint32_t rangeStart;
+        uint16_t rangeLength;
+        uint16_t glyphIdStart;
+        uint16_t entriesCount;
+        uint8_t formatType;
+        uint8_t padding;
+      };
+
+      struct CachedBitmap {
+        uint8_t* bitmap = nullptr;
+        uint16_t glyphId = 0;
+        uint16_t size = 0;
+        uint32_t lastUse = 0;
+      };
+
+      static bool GetGlyphDescriptor(const lv_font_t* font, lv_font_glyph_dsc_t* descriptor, uint32_t letter, uint32_t next);
+      static const uint8_t* GetGlyphBitmap(const lv_font_t* font, uint32_t letter);
+
+      uint32_t FindGlyphId(uint32_t letter) const;
+      const uint8_t* LoadBitmap(uint32_t glyphId);
+      // Returns the length of the section starting at offset if its label is label, 0 otherwise
+      uint32_t ReadSectionLabel(uint32_t offset, const char* label);
+      // Looks the font up again in a bundle that was replaced, returns false if it isn't the same font anymore
+      bool RelocateResource();
+      void FreeCache();
+      // Reads size bytes at offset in the font file, returns the number of bytes read or a negative littlefs error
+      int Read(uint32_t offset, uint8_t* buffer, uint32_t size);
+      void FreeIndex();
+
+      Pinetime::Controllers::FS& filesystem;
+      lv_font_t font {};
+      lfs_file_t file;
+      bool opened = false;
+      // The font is in the resource bundle, at resourceOffset, as of resourceGeneration
+      bool packed = false;
+      std::array<char, Pinetime::Controllers::ResourceBundle::maxPathLength> path {};
+      uint32_t resourceOffset = 0;
+      uint32_t resourceSize = 0;
+      uint32_t resourceGeneration = 0;
+
+      // Character maps section of the file: the tables followed by their data
+      uint8_t* cmaps = nullptr;
+      uint32_t cmapsCount = 0;
+      Glyph* glyphs = nullptr;
+      uint32_t glyphsCount = 0;
+      size_t indexSize = 0;
+
+      uint8_t bitsPerPixel = 0;
+      // Size of the fields preceding the bitmap of each glyph
+      uint8_t headerBits = 0;
+
+      std::array<CachedBitmap, 8> cache;
+      size_t cachedSize = 0;
+      uint32_t useCount = 0;
+    };
+  }
+}
@@ -2,5 +2,12 @@
 using namespace Pinetime::Applications::Screens;
 
 void Screen::RefreshTaskCallback(lv_task_t* task) {
-  static_cast<Screen*>(task->user_data)->Refresh();
+  auto* screen = static_cast<Screen*>(task->user_data);
+  screen->refreshCount++;
+  screen->Refresh();
+}
+
+void Screen::OnStateChanged() {
+  refreshCount++;
+  Refresh();
 }
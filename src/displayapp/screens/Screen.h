@@ -2,6 +2,7 @@
 
 #include <cstdint>
 #include "displayapp/TouchEvents.h"
+#include "components/changenotifier/ChangeNotifier.h"
 #include <lvgl/lvgl.h>
 
 namespace Pinetime {
@@ -21,6 +22,19 @@ namespace Pinetime {
 
         static void RefreshTaskCallback(lv_task_t* task);
 
+        /** @return the Controllers::ChangeNotifier topics shown by the screen.
+         * Screens that return topics don't need a refresh task: DisplayApp refreshes them when one of these topics
+         * changed. Time changes every minute. */
+        virtual Controllers::ChangeNotifier::TopicMask RefreshTopics() const {
+          return 0;
+        }
+
+        void OnStateChanged();
+
+        uint32_t RefreshCount() const {
+          return refreshCount;
+        }
+
         bool IsRunning() const {
           return running;
         }
@@ -40,8 +54,17 @@ namespace Pinetime {
           return false;
         }
 
+        /** Lines that stay visible in always on mode, the rest of the display is turned off.
+         * @return false to keep the whole screen visible */
+        virtual bool GetAlwaysOnBand(lv_coord_t& /*y*/, lv_coord_t& /*height*/) {
+          return false;
+        }
+
       protected:
         bool running = true;
+
+      private:
+        uint32_t refreshCount = 0;
       };
     }
   }
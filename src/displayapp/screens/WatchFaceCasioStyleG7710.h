@@ -11,6 +11,7 @@
 #include "components/ble/BleController.h"
 #include "utility/DirtyValue.h"
 #include "displayapp/apps/Apps.h"
+#include "displayapp/FontCache.h"
 
 namespace Pinetime {
   namespace Controllers {
@@ -34,7 +35,7 @@ namespace Pinetime {
                                  Controllers::Settings& settingsController,
                                  Controllers::HeartRateController& heartRateController,
                                  Controllers::MotionController& motionController,
-                                 Controllers::FS& filesystem);
+                                 Components::FontCache& fontCache);
         ~WatchFaceCasioStyleG7710() override;
 
         void Refresh() override;
@@ -94,6 +95,7 @@ namespace Pinetime {
         Controllers::Settings& settingsController;
         Controllers::HeartRateController& heartRateController;
         Controllers::MotionController& motionController;
+        Components::FontCache& fontCache;
 
         lv_task_t* taskRefresh;
         lv_font_t* font_dot40 = nullptr;
@@ -115,7 +117,7 @@ namespace Pinetime {
                                                      controllers.settingsController,
                                                      controllers.heartRateController,
                                                      controllers.motionController,
-                                                     controllers.filesystem);
+                                                     controllers.fontCache);
       };
 
       static bool IsAvailable(Pinetime::Controllers::FS& filesystem) {
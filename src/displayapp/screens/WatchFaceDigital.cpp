@@ -2,6 +2,7 @@
 
 #include <lvgl/lvgl.h>
 #include <cstdio>
+#include <algorithm>
 
 #include "displayapp/screens/NotificationIcon.h"
 #include "displayapp/screens/Symbols.h"
@@ -86,15 +87,21 @@ WatchFaceDigital::WatchFaceDigital(Controllers::DateTime& dateTimeController,
   lv_label_set_text_static(stepIcon, Symbols::shoe);
   lv_obj_align(stepIcon, stepValue, LV_ALIGN_OUT_LEFT_MID, -5, 0);
 
-  taskRefresh = lv_task_create(RefreshTaskCallback, LV_DISP_DEF_REFR_PERIOD, LV_TASK_PRIO_MID, this);
   Refresh();
 }
 
 WatchFaceDigital::~WatchFaceDigital() {
-  lv_task_del(taskRefresh);
   lv_obj_clean(lv_scr_act());
 }
 
+Pinetime::Controllers::ChangeNotifier::TopicMask WatchFaceDigital::RefreshTopics() const {
+  using Pinetime::Controllers::ChangeNotifier;
+  return ChangeNotifier::Mask(ChangeNotifier::Topics::Time) | ChangeNotifier::Mask(ChangeNotifier::Topics::Battery) |
+         ChangeNotifier::Mask(ChangeNotifier::Topics::Ble) | ChangeNotifier::Mask(ChangeNotifier::Topics::HeartRate) |
+         ChangeNotifier::Mask(ChangeNotifier::Topics::Motion) | ChangeNotifier::Mask(ChangeNotifier::Topics::Notifications) |
+         ChangeNotifier::Mask(ChangeNotifier::Topics::Weather) | ChangeNotifier::Mask(ChangeNotifier::Topics::Alarm);
+}
+
 void WatchFaceDigital::Refresh() {
   statusIcons.Update();
 
@@ -192,3 +199,15 @@ void WatchFaceDigital::Refresh() {
     lv_obj_realign(weatherIcon);
   }
 }
+
+bool WatchFaceDigital::GetAlwaysOnBand(lv_coord_t& y, lv_coord_t& height) {
+  // Status icons, notification and weather at the top, then time, AM/PM and date.
+  // Heart rate and steps at the bottom are not shown.
+  y = std::min({lv_obj_get_y(statusIcons.GetObject()),
+                lv_obj_get_y(notificationIcon),
+                lv_obj_get_y(weatherIcon),
+                lv_obj_get_y(label_time),
+                lv_obj_get_y(label_time_ampm)});
+  height = (lv_obj_get_y(label_date) + lv_obj_get_height(label_date)) - y;
+  return true;
+}
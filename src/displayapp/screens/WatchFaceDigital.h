@@ -41,6 +41,10 @@ namespace Pinetime {
 
         void Refresh() override;
 
+        Controllers::ChangeNotifier::TopicMask RefreshTopics() const override;
+
+        bool GetAlwaysOnBand(lv_coord_t& y, lv_coord_t& height) override;
+
       private:
         uint8_t displayedHour = -1;
         uint8_t displayedMinute = -1;
@@ -72,7 +76,6 @@ namespace Pinetime {
         Controllers::MotionController& motionController;
         Controllers::SimpleWeatherService& weatherService;
 
-        lv_task_t* taskRefresh;
         Widgets::StatusIcons statusIcons;
       };
     }
@@ -9,6 +9,7 @@
 #include "components/datetime/DateTimeController.h"
 #include "utility/DirtyValue.h"
 #include "displayapp/apps/Apps.h"
+#include "displayapp/FontCache.h"
 
 namespace Pinetime {
   namespace Controllers {
@@ -31,7 +32,7 @@ namespace Pinetime {
                           Controllers::NotificationManager& notificationManager,
                           Controllers::Settings& settingsController,
                           Controllers::MotionController& motionController,
-                          Controllers::FS& fs);
+                          Components::FontCache& fontCache);
 
         ~WatchFaceInfineat() override;
 
@@ -91,6 +92,7 @@ namespace Pinetime {
         Controllers::NotificationManager& notificationManager;
         Controllers::Settings& settingsController;
         Controllers::MotionController& motionController;
+        Components::FontCache& fontCache;
 
         void SetBatteryLevel(uint8_t batteryPercent);
         void ToggleBatteryIndicatorColor(bool showSideCover);
@@ -113,7 +115,7 @@ namespace Pinetime {
                                               controllers.notificationManager,
                                               controllers.settingsController,
                                               controllers.motionController,
-                                              controllers.filesystem);
+                                              controllers.fontCache);
       };
 
       static bool IsAvailable(Pinetime::Controllers::FS& filesystem) {
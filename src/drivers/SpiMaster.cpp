@@ -90,6 +90,8 @@ bool SpiMaster::Init() {
   NRFX_IRQ_PRIORITY_SET(SPIM0_SPIS0_TWIM0_TWIS0_SPI0_TWI0_IRQn, 2);
   NRFX_IRQ_ENABLE(SPIM0_SPIS0_TWIM0_TWIS0_SPI0_TWI0_IRQn);
 
+  SetupChain();
+
   xSemaphoreGive(mutex);
   return true;
 }
@@ -135,6 +137,67 @@ void SpiMaster::DisableWorkaroundForErratum58() {
   workaroundActive = false;
 }
 
+void SpiMaster::SetupChain() {
+  chainTimer->TASKS_STOP = 1;
+  chainTimer->MODE = TIMER_MODE_MODE_Counter << TIMER_MODE_MODE_Pos;
+  chainTimer->BITMODE = TIMER_BITMODE_BITMODE_16Bit << TIMER_BITMODE_BITMODE_Pos;
+  chainTimer->INTENSET = TIMER_INTENSET_COMPARE1_Msk;
+
+  nrf_ppi_channel_endpoint_setup(chainRestartPpi,
+                                 reinterpret_cast<uint32_t>(&spiBaseAddress->EVENTS_END),
+                                 reinterpret_cast<uint32_t>(&spiBaseAddress->TASKS_START));
+  nrf_ppi_channel_endpoint_setup(chainCountPpi,
+                                 reinterpret_cast<uint32_t>(&spiBaseAddress->EVENTS_END),
+                                 reinterpret_cast<uint32_t>(&chainTimer->TASKS_COUNT));
+  nrf_ppi_channel_endpoint_setup(chainStopPpi,
+                                 reinterpret_cast<uint32_t>(&chainTimer->EVENTS_COMPARE[0]),
+                                 reinterpret_cast<uint32_t>(&NRF_PPI->TASKS_CHG[chainPpiGroup].DIS));
+  nrf_ppi_channel_include_in_group(chainRestartPpi, chainPpiGroup);
+
+  NRFX_IRQ_PRIORITY_SET(TIMER3_IRQn, 2);
+  NRFX_IRQ_ENABLE(TIMER3_IRQn);
+}
+
+void SpiMaster::StartChain(size_t nbChunks) {
+  // The restart channel is disabled once the second to last chunk is sent,
+  // and the timer interrupts when the last one is done
+  chainTimer->TASKS_CLEAR = 1;
+  chainTimer->CC[0] = nbChunks - 1;
+  chainTimer->CC[1] = nbChunks;
+  chainTimer->EVENTS_COMPARE[0] = 0;
+  chainTimer->EVENTS_COMPARE[1] = 0;
+  chainTimer->TASKS_START = 1;
+
+  // No per chunk interrupt while the chain is running
+  spiBaseAddress->INTENCLR = (1 << 6);
+  spiBaseAddress->INTENCLR = (1 << 19);
+
+  PrepareTx(currentBufferAddr, maxChunkSize);
+  spiBaseAddress->TXD.LIST = SPIM_TXD_LIST_LIST_ArrayList << SPIM_TXD_LIST_LIST_Pos;
+  currentBufferAddr = currentBufferAddr + (nbChunks * maxChunkSize);
+  currentBufferSize = currentBufferSize - (nbChunks * maxChunkSize);
+
+  nrf_ppi_channel_enable(chainCountPpi);
+  nrf_ppi_channel_enable(chainStopPpi);
+  nrf_ppi_group_enable(chainPpiGroup);
+  spiBaseAddress->TASKS_START = 1;
+}
+
+void SpiMaster::OnChainEndEvent() {
+  chainTimer->TASKS_STOP = 1;
+  nrf_ppi_channel_disable(chainCountPpi);
+  nrf_ppi_channel_disable(chainStopPpi);
+
+  // END of the last chunk is still set, it would raise another interrupt as soon as it is enabled
+  spiBaseAddress->EVENTS_END = 0;
+  spiBaseAddress->EVENTS_STARTED = 0;
+  spiBaseAddress->INTENSET = (1 << 6);
+  spiBaseAddress->INTENSET = (1 << 19);
+
+  // Send the remaining bytes or release the bus, just like at the end of a single chunk
+  OnEndEvent();
+}
+
 void SpiMaster::OnEndEvent() {
   if (currentBufferAddr == 0) {
     return;
@@ -142,7 +205,7 @@ void SpiMaster::OnEndEvent() {
 
   auto s = currentBufferSize;
   if (s > 0) {
-    auto currentSize = std::min((size_t) 255, s);
+    auto currentSize = std::min(maxChunkSize, s);
     PrepareTx(currentBufferAddr, currentSize);
     currentBufferAddr = currentBufferAddr + currentSize;
     currentBufferSize = currentBufferSize - currentSize;
@@ -202,11 +265,15 @@ bool SpiMaster::Write(uint8_t pinCsn, const uint8_t* data, size_t size, const st
   currentBufferAddr = (uint32_t) data;
   currentBufferSize = size;
 
-  auto currentSize = std::min((size_t) 255, (size_t) currentBufferSize);
-  PrepareTx(currentBufferAddr, currentSize);
-  currentBufferSize = currentBufferSize - currentSize;
-  currentBufferAddr = currentBufferAddr + currentSize;
-  spiBaseAddress->TASKS_START = 1;
+  if (size >= 2 * maxChunkSize) {
+    StartChain(size / maxChunkSize);
+  } else {
+    auto currentSize = std::min(maxChunkSize, (size_t) currentBufferSize);
+    PrepareTx(currentBufferAddr, currentSize);
+    currentBufferSize = currentBufferSize - currentSize;
+    currentBufferAddr = currentBufferAddr + currentSize;
+    spiBaseAddress->TASKS_START = 1;
+  }
 
   if (size == 1) {
     while (spiBaseAddress->EVENTS_END == 0)
@@ -241,11 +308,18 @@ bool SpiMaster::Read(uint8_t pinCsn, uint8_t* cmd, size_t cmdSize, uint8_t* data
   while (spiBaseAddress->EVENTS_END == 0)
     ;
 
-  PrepareRx((uint32_t) data, dataSize);
-  spiBaseAddress->TASKS_START = 1;
+  // The data is received in several transfers if it doesn't fit in one EasyDMA transfer, CS stays low in between
+  size_t remaining = dataSize;
+  do {
+    const size_t chunkSize = std::min(maxChunkSize, remaining);
+    PrepareRx((uint32_t) data, chunkSize);
+    spiBaseAddress->TASKS_START = 1;
 
-  while (spiBaseAddress->EVENTS_END == 0)
-    ;
+    while (spiBaseAddress->EVENTS_END == 0)
+      ;
+    data += chunkSize;
+    remaining -= chunkSize;
+  } while (remaining > 0);
   nrf_gpio_pin_set(this->pinCsn);
 
   xSemaphoreGive(mutex);
@@ -253,6 +327,12 @@ bool SpiMaster::Read(uint8_t pinCsn, uint8_t* cmd, size_t cmdSize, uint8_t* data
   return true;
 }
 
+void SpiMaster::WaitForTransfer() {
+  // Write() keeps the mutex until the last byte of an asynchronous transfer is sent
+  xSemaphoreTake(mutex, portMAX_DELAY);
+  xSemaphoreGive(mutex);
+}
+
 void SpiMaster::Sleep() {
   while (spiBaseAddress->ENABLE != 0) {
     spiBaseAddress->ENABLE = (SPIM_ENABLE_ENABLE_Disabled << SPIM_ENABLE_ENABLE_Pos);
@@ -288,11 +368,17 @@ bool SpiMaster::WriteCmdAndBuffer(uint8_t pinCsn, const uint8_t* cmd, size_t cmd
   while (spiBaseAddress->EVENTS_END == 0)
     ;
 
-  PrepareTx((uint32_t) data, dataSize);
-  spiBaseAddress->TASKS_START = 1;
+  size_t remaining = dataSize;
+  do {
+    const size_t chunkSize = std::min(maxChunkSize, remaining);
+    PrepareTx((uint32_t) data, chunkSize);
+    spiBaseAddress->TASKS_START = 1;
 
-  while (spiBaseAddress->EVENTS_END == 0)
-    ;
+    while (spiBaseAddress->EVENTS_END == 0)
+      ;
+    data += chunkSize;
+    remaining -= chunkSize;
+  } while (remaining > 0);
   nrf_gpio_pin_set(this->pinCsn);
 
   xSemaphoreGive(mutex);
@@ -38,9 +38,11 @@ namespace Pinetime {
       bool Read(uint8_t pinCsn, uint8_t* cmd, size_t cmdSize, uint8_t* data, size_t dataSize);
 
       bool WriteCmdAndBuffer(uint8_t pinCsn, const uint8_t* cmd, size_t cmdSize, const uint8_t* data, size_t dataSize);
+      void WaitForTransfer();
 
       void OnStartedEvent();
       void OnEndEvent();
+      void OnChainEndEvent();
 
       void Sleep();
       void Wakeup();
@@ -50,6 +52,8 @@ namespace Pinetime {
       void DisableWorkaroundForErratum58();
       void PrepareTx(const volatile uint32_t bufferAddress, const volatile size_t size);
       void PrepareRx(const volatile uint32_t bufferAddress, const volatile size_t size);
+      void SetupChain();
+      void StartChain(size_t nbChunks);
 
       NRF_SPIM_Type* spiBaseAddress;
       uint8_t pinCsn;
@@ -62,6 +66,16 @@ namespace Pinetime {
       SemaphoreHandle_t mutex = nullptr;
       static constexpr nrf_ppi_channel_t workaroundPpi = NRF_PPI_CHANNEL0;
       bool workaroundActive = false;
+
+      // Buffers larger than one EasyDMA transfer are sent as a chain of maxChunkSize chunks in array list mode.
+      // PPI restarts the SPIM on every END event and a timer in counter mode counts the chunks: it stops the
+      // chain before the last chunk and raises a single interrupt once it is sent.
+      static constexpr size_t maxChunkSize = 255;
+      static constexpr nrf_ppi_channel_t chainRestartPpi = NRF_PPI_CHANNEL3;
+      static constexpr nrf_ppi_channel_t chainCountPpi = NRF_PPI_CHANNEL6;
+      static constexpr nrf_ppi_channel_t chainStopPpi = NRF_PPI_CHANNEL7;
+      static constexpr nrf_ppi_channel_group_t chainPpiGroup = NRF_PPI_CHANNEL_GROUP0;
+      NRF_TIMER_Type* const chainTimer = NRF_TIMER3;
     };
   }
 }
@@ -21,6 +21,7 @@ void SpiNorFlash::Uninit() {
 }
 
 void SpiNorFlash::Sleep() {
+  WaitForErase();
   auto cmd = static_cast<uint8_t>(Commands::DeepPowerDown);
   spi.Write(&cmd, sizeof(uint8_t), nullptr);
   NRF_LOG_INFO("[SpiNorFlash] Sleep")
@@ -71,6 +72,7 @@ uint8_t SpiNorFlash::ReadConfigurationRegister() {
 }
 
 void SpiNorFlash::Read(uint32_t address, uint8_t* buffer, size_t size) {
+  WaitForErase();
   static constexpr uint8_t cmdSize = 4;
   uint8_t cmd[cmdSize] = {static_cast<uint8_t>(Commands::Read),
                           static_cast<uint8_t>(address >> 16U),
@@ -85,20 +87,58 @@ void SpiNorFlash::WriteEnable() {
 }
 
 void SpiNorFlash::SectorErase(uint32_t sectorAddress) {
+  StartErase(sectorAddress, sectorSize);
+  WaitForErase();
+}
+
+size_t SpiNorFlash::StartErase(uint32_t address, size_t size) {
+  WaitForErase();
+
+  Commands command = Commands::SectorErase;
+  size_t eraseSize = sectorSize;
+  if ((address % block64KSize) == 0 && size >= block64KSize) {
+    command = Commands::BlockErase64K;
+    eraseSize = block64KSize;
+  } else if ((address % block32KSize) == 0 && size >= block32KSize) {
+    command = Commands::BlockErase32K;
+    eraseSize = block32KSize;
+  }
+
   static constexpr uint8_t cmdSize = 4;
-  uint8_t cmd[cmdSize] = {static_cast<uint8_t>(Commands::SectorErase),
-                          static_cast<uint8_t>(sectorAddress >> 16U),
-                          static_cast<uint8_t>(sectorAddress >> 8U),
-                          static_cast<uint8_t>(sectorAddress)};
+  uint8_t cmd[cmdSize] = {static_cast<uint8_t>(command),
+                          static_cast<uint8_t>(address >> 16U),
+                          static_cast<uint8_t>(address >> 8U),
+                          static_cast<uint8_t>(address)};
 
   WriteEnable();
   while (!WriteEnabled())
     vTaskDelay(1);
 
   spi.Read(reinterpret_cast<uint8_t*>(&cmd), cmdSize, nullptr, 0);
+  erasing = true;
+  return eraseSize;
+}
 
-  while (WriteInProgress())
-    vTaskDelay(1);
+bool SpiNorFlash::IsErasing() {
+  if (erasing && !WriteInProgress()) {
+    erasing = false;
+  }
+  return erasing;
+}
+
+void SpiNorFlash::WaitForErase() {
+  if (erasing) {
+    WaitWhileBusy(0, 0);
+    erasing = false;
+  }
+}
+
+void SpiNorFlash::EraseRange(uint32_t address, size_t size) {
+  const uint32_t end = address + size;
+  while (address < end) {
+    address += StartErase(address, end - address);
+  }
+  WaitForErase();
 }
 
 uint8_t SpiNorFlash::ReadSecurityRegister() {
@@ -113,11 +153,13 @@ bool SpiNorFlash::ProgramFailed() {
 }
 
 bool SpiNorFlash::EraseFailed() {
+  WaitForErase();
   return (ReadSecurityRegister() & 0x40u) == 0x40u;
 }
 
 void SpiNorFlash::Write(uint32_t address, const uint8_t* buffer, size_t size) {
   static constexpr uint8_t cmdSize = 4;
+  WaitForErase();
 
   size_t len = size;
   uint32_t addr = address;
@@ -131,14 +173,11 @@ void SpiNorFlash::Write(uint32_t address, const uint8_t* buffer, size_t size) {
                             static_cast<uint8_t>(addr >> 8U),
                             static_cast<uint8_t>(addr)};
 
+    // The write enable latch is set as soon as the command is sent, no need to read it back
     WriteEnable();
-    while (!WriteEnabled())
-      vTaskDelay(1);
-
     spi.WriteCmdAndBuffer(cmd, cmdSize, b, toWrite);
 
-    while (WriteInProgress())
-      vTaskDelay(1);
+    WaitWhileBusy(pageProgramPollIntervalUs, pageProgramSpinTimeUs);
 
     addr += toWrite;
     b += toWrite;
@@ -146,6 +185,18 @@ void SpiNorFlash::Write(uint32_t address, const uint8_t* buffer, size_t size) {
   }
 }
 
+void SpiNorFlash::WaitWhileBusy(uint32_t pollIntervalUs, uint32_t spinTimeUs) {
+  uint32_t spinTime = 0;
+  while (WriteInProgress()) {
+    if (spinTime < spinTimeUs) {
+      nrf_delay_us(pollIntervalUs);
+      spinTime += pollIntervalUs;
+    } else {
+      vTaskDelay(1);
+    }
+  }
+}
+
 SpiNorFlash::Identification SpiNorFlash::GetIdentification() const {
   return device_id;
 }
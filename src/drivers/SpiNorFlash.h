@@ -1,4 +1,5 @@
 #pragma once
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
 
@@ -24,10 +25,21 @@ namespace Pinetime {
       bool WriteInProgress();
       bool WriteEnabled();
       uint8_t ReadConfigurationRegister();
+      // Reads any number of bytes in a single read command
       void Read(uint32_t address, uint8_t* buffer, size_t size);
+      // Programs any number of bytes, one page program command per page crossed
       void Write(uint32_t address, const uint8_t* buffer, size_t size);
       void WriteEnable();
       void SectorErase(uint32_t sectorAddress);
+
+      // Starts erasing the largest unit (64KB block, 32KB block or 4KB sector) aligned on address that fits in size,
+      // and returns its size. A sector is erased if size is smaller than a sector. The erase runs in the background:
+      // the other commands wait for it to complete before accessing the flash.
+      size_t StartErase(uint32_t address, size_t size);
+      bool IsErasing();
+      void WaitForErase();
+      // Erases all the sectors overlapping [address, address + size), address must be aligned on a sector
+      void EraseRange(uint32_t address, size_t size);
       uint8_t ReadSecurityRegister();
       bool ProgramFailed();
       bool EraseFailed();
@@ -42,6 +54,9 @@ namespace Pinetime {
 
     private:
       Identification ReadIdentification();
+      // Polls the status register every pollIntervalUs while the flash is busy, for up to spinTimeUs,
+      // then every tick to let the other tasks run during long operations.
+      void WaitWhileBusy(uint32_t pollIntervalUs, uint32_t spinTimeUs);
 
       enum class Commands : uint8_t {
         PageProgram = 0x02,
@@ -50,15 +65,25 @@ namespace Pinetime {
         WriteEnable = 0x06,
         ReadConfigurationRegister = 0x15,
         SectorErase = 0x20,
+        BlockErase32K = 0x52,
+        BlockErase64K = 0xD8,
         ReadSecurityRegister = 0x2B,
         ReadIdentification = 0x9F,
         ReleaseFromDeepPowerDown = 0xAB,
         DeepPowerDown = 0xB9
       };
       static constexpr uint16_t pageSize = 256;
+      static constexpr uint32_t sectorSize = 4 * 1024;
+      static constexpr uint32_t block32KSize = 32 * 1024;
+      static constexpr uint32_t block64KSize = 64 * 1024;
+      // A page program takes ~0.7ms, less than a tick: waiting for the next tick after each page
+      // would about halve the write throughput.
+      static constexpr uint32_t pageProgramPollIntervalUs = 50;
+      static constexpr uint32_t pageProgramSpinTimeUs = 1500;
 
       Spi& spi;
       Identification device_id;
+      std::atomic<bool> erasing {false};
     };
   }
 }
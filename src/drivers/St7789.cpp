@@ -56,6 +56,8 @@ void St7789::WriteCommand(const uint8_t* data, size_t size) {
 }
 
 void St7789::WriteSpi(const uint8_t* data, size_t size, const std::function<void()>& preTransactionHook) {
+  statistics.transactions++;
+  statistics.bytes += size;
   spi.Write(data, size, preTransactionHook);
 }
 
@@ -159,7 +161,7 @@ void St7789::PorchSet() {
     0x03, // Normal mode back porch
     0x01, // Porch control enable
     0xed, // Idle mode front:back porch
-    0xed, // Partial mode front:back porch (partial mode unused but set anyway)
+    0xed, // Partial mode front:back porch
   };
   WriteData(args, sizeof(args));
 }
@@ -178,7 +180,7 @@ void St7789::IdleFrameRateOn() {
   constexpr uint8_t args[] = {
     0x12, // Enable frame rate control for partial/idle mode, 4x frame divider
     0x1e, // Idle mode frame rate
-    0x1e, // Partial mode frame rate (unused)
+    0x1e, // Partial mode frame rate
   };
   WriteData(args, sizeof(args));
 }
@@ -188,7 +190,7 @@ void St7789::IdleFrameRateOff() {
   constexpr uint8_t args[] = {
     0x00, // Disable frame rate control and divider
     0x0a, // Idle mode frame rate (normal)
-    0x0a, // Partial mode frame rate (normal, unused)
+    0x0a, // Partial mode frame rate (normal)
   };
   WriteData(args, sizeof(args));
 }
@@ -242,6 +244,11 @@ void St7789::WriteToRam(const uint8_t* data, size_t size) {
   WriteData(data, size);
 }
 
+void St7789::WriteToRamContinue(const uint8_t* data, size_t size) {
+  WriteCommand(static_cast<uint8_t>(Commands::WriteToRamContinue));
+  WriteData(data, size);
+}
+
 void St7789::SetVdv() {
   // By default there is a large step from pixel brightness zero to one.
   // After experimenting with VCOMS, VRH and VDV, this was found to produce good results.
@@ -255,6 +262,7 @@ void St7789::DisplayOff() {
 
 void St7789::VerticalScrollStartAddress(uint16_t line) {
   verticalScrollingStartAddress = line;
+  addrWindowValid = false;
   WriteCommand(static_cast<uint8_t>(Commands::VerticalScrollStartAddress));
   uint8_t args[] = {
     static_cast<uint8_t>(line >> 8), // Frame memory line pointer MSB
@@ -268,8 +276,26 @@ void St7789::Uninit() {
 }
 
 void St7789::DrawBuffer(uint16_t x, uint16_t y, uint16_t width, uint16_t height, const uint8_t* data, size_t size) {
-  SetAddrWindow(x, y, x + width - 1, y + height - 1);
-  WriteToRam(data, size);
+  // LVGL flushes an area as consecutive blocks of lines. The address window is opened down to the last
+  // line of the GRAM, so a block that directly follows the previous one can be written with
+  // WriteToRamContinue, without sending a new address window.
+  const uint16_t x1 = x + width - 1;
+  if (addrWindowValid && x == addrWindowX0 && x1 == addrWindowX1 && y == addrWindowNextRow) {
+    WriteToRamContinue(data, size);
+  } else {
+    SetAddrWindow(x, y, x1, Height - 1);
+    statistics.addressWindows++;
+    WriteToRam(data, size);
+  }
+
+  addrWindowX0 = x;
+  addrWindowX1 = x1;
+  addrWindowNextRow = y + height;
+  addrWindowValid = addrWindowNextRow < Height;
+}
+
+void St7789::WaitForTransfer() {
+  spi.WaitForTransfer();
 }
 
 void St7789::HardwareReset() {
@@ -295,8 +321,31 @@ void St7789::LowPowerOff() {
   NRF_LOG_INFO("[LCD] Normal power mode");
 }
 
+void St7789::PartialModeOn(uint16_t y0, uint16_t y1) {
+  // The partial area is given in frame memory lines, which are shifted by the vertical scrolling
+  const uint16_t start = (y0 + verticalScrollingStartAddress) % Height;
+  const uint16_t end = (y1 + verticalScrollingStartAddress) % Height;
+  WriteCommand(static_cast<uint8_t>(Commands::PartialArea));
+  uint8_t args[] = {
+    static_cast<uint8_t>(start >> 8), // Start row MSB
+    static_cast<uint8_t>(start),      // Start row LSB
+    static_cast<uint8_t>(end >> 8),   // End row MSB
+    static_cast<uint8_t>(end)         // End row LSB
+  };
+  memcpy(partialAreaArgs, args, sizeof(args));
+  WriteData(partialAreaArgs, sizeof(partialAreaArgs));
+  WriteCommand(static_cast<uint8_t>(Commands::PartialModeOn));
+  NRF_LOG_INFO("[LCD] Partial mode, lines %d to %d", y0, y1);
+}
+
+void St7789::PartialModeOff() {
+  NormalModeOn();
+  NRF_LOG_INFO("[LCD] Partial mode off");
+}
+
 void St7789::Sleep() {
   SleepIn();
+  addrWindowValid = false;
   nrf_gpio_cfg_default(pinDataCommand);
   NRF_LOG_INFO("[LCD] Sleep");
 }
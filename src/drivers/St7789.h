@@ -11,6 +11,12 @@ namespace Pinetime {
 
     class St7789 {
     public:
+      struct Statistics {
+        uint32_t transactions = 0;
+        uint32_t bytes = 0;
+        uint32_t addressWindows = 0;
+      };
+
       explicit St7789(Spi& spi, uint8_t pinDataCommand, uint8_t pinReset);
       St7789(const St7789&) = delete;
       St7789& operator=(const St7789&) = delete;
@@ -23,12 +29,20 @@ namespace Pinetime {
       void VerticalScrollStartAddress(uint16_t line);
 
       void DrawBuffer(uint16_t x, uint16_t y, uint16_t width, uint16_t height, const uint8_t* data, size_t size);
+      void WaitForTransfer();
 
       void LowPowerOn();
       void LowPowerOff();
+      // Only drive the lines y0 to y1 of the screen, the rest of the panel is not refreshed and stays black
+      void PartialModeOn(uint16_t y0, uint16_t y1);
+      void PartialModeOff();
       void Sleep();
       void Wakeup();
 
+      const Statistics& GetStatistics() const {
+        return statistics;
+      }
+
     private:
       Spi& spi;
       uint8_t pinDataCommand;
@@ -48,6 +62,7 @@ namespace Pinetime {
       void DisplayInversionOn();
       void NormalModeOn();
       void WriteToRam(const uint8_t* data, size_t size);
+      void WriteToRamContinue(const uint8_t* data, size_t size);
       void IdleModeOn();
       void IdleModeOff();
       void FrameRateNormalSet();
@@ -69,6 +84,7 @@ namespace Pinetime {
         SoftwareReset = 0x01,
         SleepIn = 0x10,
         SleepOut = 0x11,
+        PartialModeOn = 0x12,
         NormalModeOn = 0x13,
         DisplayInversionOn = 0x21,
         DisplayOff = 0x28,
@@ -76,12 +92,14 @@ namespace Pinetime {
         ColumnAddressSet = 0x2a,
         RowAddressSet = 0x2b,
         WriteToRam = 0x2c,
+        PartialArea = 0x30,
         MemoryDataAccessControl = 0x36,
         VerticalScrollDefinition = 0x33,
         VerticalScrollStartAddress = 0x37,
         IdleModeOff = 0x38,
         IdleModeOn = 0x39,
         PixelFormat = 0x3a,
+        WriteToRamContinue = 0x3c,
         FrameRateIdle = 0xb3,
         FrameRateNormal = 0xc6,
         VdvSet = 0xc4,
@@ -99,6 +117,15 @@ namespace Pinetime {
 
       uint8_t addrWindowArgs[4];
       uint8_t verticalScrollArgs[2];
+      uint8_t partialAreaArgs[4];
+
+      // Column range of the current address window and the row the next pixel will be written to
+      bool addrWindowValid = false;
+      uint16_t addrWindowX0 = 0;
+      uint16_t addrWindowX1 = 0;
+      uint16_t addrWindowNextRow = 0;
+
+      Statistics statistics;
     };
   }
 }
@@ -1,14 +1,23 @@
 #include "heartratetask/HeartRateTask.h"
 #include <drivers/Hrs3300.h>
 #include <components/heartrate/HeartRateController.h>
+#include <cstdlib>
 #include <limits>
+#include <nrf_log.h>
 
+#include "utility/CycleCounter.h"
 #include "utility/Math.h"
 
 using namespace Pinetime::Applications;
 
 namespace {
   constexpr TickType_t backgroundMeasurementTimeLimit = 30 * configTICK_RATE_HZ;
+  // A background measurement ends when two consecutive analyses find heart rates that differ by at most this many BPM.
+  // They are compared before averaging: the average of the last 20 analyses hardly changes from one to the next.
+  constexpr int backgroundConvergenceTolerance = 3;
+  // A background measurement is abandoned until the next period after this many resets caused by ambient light,
+  // the watch is probably not worn
+  constexpr uint8_t backgroundAmbientResetsLimit = 2;
 }
 
 std::optional<TickType_t> HeartRateTask::BackgroundMeasurementInterval() const {
@@ -93,6 +102,7 @@ HeartRateTask::HeartRateTask(Drivers::Hrs3300& heartRateSensor,
 void HeartRateTask::Start() {
   messageQueue = xQueueCreate(10, 1);
   controller.SetHeartRateTask(this);
+  Utility::CycleCounter::Enable();
 
   if (pdPASS != xTaskCreate(HeartRateTask::Process, "Heartrate", 500, this, 1, &taskHandle)) {
     APP_ERROR_HANDLER(NRF_ERROR_NO_MEM);
@@ -108,6 +118,7 @@ void HeartRateTask::Work() {
   // measurementStartTime is always initialised before use by StartMeasurement
   // Need to initialise lastMeasurementTime so that the first background measurement happens at a reasonable time
   lastMeasurementTime = xTaskGetTickCount();
+  previousSensorEnableTime = lastMeasurementTime;
   valueCurrentlyShown = false;
 
   while (true) {
@@ -179,16 +190,35 @@ void HeartRateTask::PushMessage(HeartRateTask::Messages msg) {
 }
 
 void HeartRateTask::StartMeasurement() {
+  sensorEnableTime = xTaskGetTickCount();
   heartRateSensor.Enable();
   ppg.Reset(true);
+  ppg.ResetStatistics();
   vTaskDelay(100);
   measurementSucceeded = false;
+  lastAnalysisBpm = 0;
+  ambientResets = 0;
   count = 0;
   measurementStartTime = xTaskGetTickCount();
 }
 
 void HeartRateTask::StopMeasurement() {
+  const auto& statistics = ppg.GetStatistics();
+  NRF_LOG_INFO("[HeartRate] %d samples, first value after %d, %d analyses (%dus average, %dus max)",
+               statistics.samples,
+               statistics.samplesToFirstValue,
+               statistics.analyses,
+               statistics.analyses > 0 ? Utility::CycleCounter::ToMicroseconds(statistics.cycles / statistics.analyses) : 0,
+               Utility::CycleCounter::ToMicroseconds(statistics.maxCycles));
   heartRateSensor.Disable();
+  // Time with the LED on, and its ratio to the time since the sensor was enabled for the previous measurement
+  const TickType_t now = xTaskGetTickCount();
+  const TickType_t enabledTicks = now - sensorEnableTime;
+  const TickType_t periodTicks = now - previousSensorEnableTime;
+  NRF_LOG_INFO("[HeartRate] sensor enabled %dms, duty cycle %d/1000",
+               static_cast<uint32_t>((static_cast<uint64_t>(enabledTicks) * 1000) / configTICK_RATE_HZ),
+               periodTicks > 0 ? static_cast<uint32_t>((static_cast<uint64_t>(enabledTicks) * 1000) / periodTicks) : 0);
+  previousSensorEnableTime = sensorEnableTime;
   ppg.Reset(true);
   vTaskDelay(100);
 }
@@ -197,6 +227,10 @@ void HeartRateTask::HandleSensorData() {
   auto sensorData = heartRateSensor.ReadHrsAls();
   int8_t ambient = ppg.Preprocess(sensorData.hrs, sensorData.als);
   int bpm = ppg.HeartRate();
+#ifdef HEARTRATE_TRACE
+  // Samples in CSV, to be replayed through Ppg and compared with a reference heart rate
+  NRF_LOG_INFO("[HeartRate] trace %d,%d,%d", sensorData.hrs, sensorData.als, bpm);
+#endif
 
   // Ambient light detected
   if (ambient > 0) {
@@ -204,7 +238,13 @@ void HeartRateTask::HandleSensorData() {
     ppg.Reset(true);
     controller.Update(Controllers::HeartRateController::States::NotEnoughData, bpm);
     bpm = 0;
+    lastAnalysisBpm = 0;
     valueCurrentlyShown = false;
+    // Off the wrist: stop sampling until the next background period instead of keeping the LED on
+    // until the time limit
+    if (state == States::BackgroundMeasuring && ++ambientResets >= backgroundAmbientResetsLimit) {
+      lastMeasurementTime = xTaskGetTickCount();
+    }
   }
 
   // Reset requested, or not enough data
@@ -213,6 +253,7 @@ void HeartRateTask::HandleSensorData() {
     ppg.Reset(false);
     // Set HR to zero and update
     bpm = 0;
+    lastAnalysisBpm = 0;
     controller.Update(Controllers::HeartRateController::States::Running, bpm);
     valueCurrentlyShown = false;
   } else if (bpm == -2) {
@@ -224,6 +265,22 @@ void HeartRateTask::HandleSensorData() {
   }
 
   if (bpm != 0) {
+    const int analysisBpm = ppg.LastAnalysisHeartRate();
+    const bool converged =
+      lastAnalysisBpm != 0 && analysisBpm != 0 && std::abs(analysisBpm - lastAnalysisBpm) <= backgroundConvergenceTolerance;
+    lastAnalysisBpm = analysisBpm;
+    measurementSucceeded = true;
+    valueCurrentlyShown = true;
+    controller.Update(Controllers::HeartRateController::States::Running, bpm);
+    // In background mode, keep measuring until the heart rate is stable
+    if (state == States::BackgroundMeasuring && !converged) {
+      // Not stable within the time limit: keep the last value and wait a full period from now. Backdating it by the
+      // time limit would make the 30s interval (equal to the limit) start the next measurement right away, with the LED on
+      if (xTaskGetTickCount() - measurementStartTime > backgroundMeasurementTimeLimit) {
+        lastMeasurementTime = xTaskGetTickCount();
+      }
+      return;
+    }
     // Maintain constant frequency acquisition in background mode
     // If the last measurement time is set to the start time, then the next measurement
     // will start exactly one background period after this one
@@ -233,9 +290,6 @@ void HeartRateTask::HandleSensorData() {
     } else {
       lastMeasurementTime = xTaskGetTickCount();
     }
-    measurementSucceeded = true;
-    valueCurrentlyShown = true;
-    controller.Update(Controllers::HeartRateController::States::Running, bpm);
     return;
   }
   // If been measuring for longer than the time limit, set the last measurement time
@@ -43,6 +43,9 @@ namespace Pinetime {
       QueueHandle_t messageQueue;
       bool valueCurrentlyShown;
       bool measurementSucceeded;
+      // Heart rate found by the previous analysis of the current measurement, before averaging. 0 if none
+      int lastAnalysisBpm;
+      uint8_t ambientResets;
       States state = States::Disabled;
       uint16_t count;
       Drivers::Hrs3300& heartRateSensor;
@@ -51,6 +54,8 @@ namespace Pinetime {
       Controllers::Ppg ppg;
       TickType_t lastMeasurementTime;
       TickType_t measurementStartTime;
+      TickType_t sensorEnableTime;
+      TickType_t previousSensorEnableTime;
     };
 
   }
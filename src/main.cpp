@@ -29,6 +29,7 @@
 
 #include "BootloaderVersion.h"
 #include "components/battery/BatteryController.h"
+#include "components/changenotifier/ChangeNotifier.h"
 #include "components/ble/BleController.h"
 #include "components/ble/NotificationManager.h"
 #include "components/brightness/BrightnessController.h"
@@ -91,22 +92,23 @@ Pinetime::Drivers::Hrs3300 heartRateSensor {twiMaster, heartRateSensorTwiAddress
 
 TimerHandle_t debounceTimer;
 TimerHandle_t debounceChargeTimer;
-Pinetime::Controllers::Battery batteryController;
-Pinetime::Controllers::Ble bleController;
+Pinetime::Controllers::ChangeNotifier changeNotifier;
+Pinetime::Controllers::Battery batteryController {changeNotifier};
+Pinetime::Controllers::Ble bleController {changeNotifier};
 
 Pinetime::Controllers::FS fs {spiNorFlash};
 Pinetime::Controllers::Settings settingsController {fs};
 Pinetime::Controllers::MotorController motorController {};
 
-Pinetime::Controllers::HeartRateController heartRateController;
+Pinetime::Controllers::HeartRateController heartRateController {changeNotifier};
 Pinetime::Applications::HeartRateTask heartRateApp(heartRateSensor, heartRateController, settingsController);
 
-Pinetime::Controllers::DateTime dateTimeController {settingsController};
+Pinetime::Controllers::DateTime dateTimeController {settingsController, changeNotifier};
 Pinetime::Drivers::Watchdog watchdog;
-Pinetime::Controllers::NotificationManager notificationManager;
-Pinetime::Controllers::MotionController motionController;
+Pinetime::Controllers::NotificationManager notificationManager {changeNotifier};
+Pinetime::Controllers::MotionController motionController {changeNotifier};
 Pinetime::Controllers::StopWatchController stopWatchController;
-Pinetime::Controllers::AlarmController alarmController {dateTimeController, fs};
+Pinetime::Controllers::AlarmController alarmController {dateTimeController, fs, changeNotifier};
 Pinetime::Controllers::TouchHandler touchHandler;
 Pinetime::Controllers::ButtonHandler buttonHandler;
 Pinetime::Controllers::BrightnessController brightnessController {};
@@ -127,7 +129,8 @@ Pinetime::Applications::DisplayApp displayApp(lcd,
                                               brightnessController,
                                               touchHandler,
                                               fs,
-                                              spiNorFlash);
+                                              spiNorFlash,
+                                              changeNotifier);
 
 Pinetime::System::SystemTask systemTask(spi,
                                         spiNorFlash,
@@ -149,7 +152,8 @@ Pinetime::System::SystemTask systemTask(spi,
                                         heartRateApp,
                                         fs,
                                         touchHandler,
-                                        buttonHandler);
+                                        buttonHandler,
+                                        changeNotifier);
 int mallocFailedCount = 0;
 int stackOverflowCount = 0;
 extern "C" {
@@ -212,6 +216,15 @@ void SPIM0_SPIS0_TWIM0_TWIS0_SPI0_TWI0_IRQHandler(void) {
   }
 }
 
+extern "C" {
+void TIMER3_IRQHandler(void) {
+  if (NRF_TIMER3->EVENTS_COMPARE[1] == 1) {
+    NRF_TIMER3->EVENTS_COMPARE[1] = 0;
+    spi.OnChainEndEvent();
+  }
+}
+}
+
 static void (*radio_isr_addr)();
 static void (*rng_isr_addr)();
 static void (*rtc0_isr_addr)();
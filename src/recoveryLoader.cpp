@@ -72,6 +72,13 @@ void SPIM0_SPIS0_TWIM0_TWIS0_SPI0_TWI0_IRQHandler(void) {
     NRF_SPIM0->EVENTS_STOPPED = 0;
   }
 }
+
+void TIMER3_IRQHandler(void) {
+  if (NRF_TIMER3->EVENTS_COMPARE[1] == 1) {
+    NRF_TIMER3->EVENTS_COMPARE[1] = 0;
+    spi.OnChainEndEvent();
+  }
+}
 }
 
 void RefreshWatchdog() {
@@ -95,8 +102,9 @@ void Process(void* /*instance*/) {
   DisplayLogo();
 
   NRF_LOG_INFO("Erasing...");
-  for (uint32_t erased = 0; erased < sizeof(recoveryImage); erased += 0x1000) {
-    spiNorFlash.SectorErase(erased);
+  for (uint32_t erased = 0; erased < sizeof(recoveryImage);) {
+    erased += spiNorFlash.StartErase(erased, sizeof(recoveryImage) - erased);
+    spiNorFlash.WaitForErase();
     RefreshWatchdog();
   }
 
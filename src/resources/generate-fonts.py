@@ -68,6 +68,7 @@ def main():
         font['sources'] = [Source(thing) for thing in sources]
         extension = 'c' if font['format'] != 'bin' else 'bin'
         font.pop('target_path')
+        font.pop('streamed', None)
         line = gen_lvconv_line(args.lv_font_conv, f'{name}.{extension}', **font)
         subprocess.check_call(line)
         if patches:
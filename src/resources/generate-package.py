@@ -7,9 +7,103 @@ import shutil
 import typing
 import os.path
 import argparse
+import struct
 import subprocess
 from zipfile import ZipFile
 
+BUNDLE_NAME = 'resources.pak'
+BUNDLE_PATH = '/' + BUNDLE_NAME
+BUNDLE_MAGIC = b'IRES'
+BUNDLE_VERSION = 2
+BUNDLE_MAX_PATH_LENGTH = 32
+
+HEATSHRINK_WINDOW_BITS = 8
+HEATSHRINK_LOOKAHEAD_BITS = 4
+
+def heatshrink_compress(data: bytes) -> bytes:
+    """Compresses data in the heatshrink format decoded by components/heatshrink/HeatshrinkDecoder.h"""
+    window_size = 1 << HEATSHRINK_WINDOW_BITS
+    max_length = 1 << HEATSHRINK_LOOKAHEAD_BITS
+    # A backreference (1 + window + lookahead bits) is shorter than 2 literals (2 * 9 bits)
+    min_length = 2
+    bits = []
+    candidates = {}
+    position = 0
+    while position < len(data):
+        best_length = 0
+        best_distance = 0
+        key = data[position:position + min_length]
+        for candidate in reversed(candidates.get(key, [])):
+            distance = position - candidate
+            if distance > window_size:
+                break
+            length = 0
+            while (length < max_length and position + length < len(data)
+                   and data[candidate + length] == data[position + length]):
+                length += 1
+            if length > best_length:
+                best_length = length
+                best_distance = distance
+                if length == max_length:
+                    break
+        if best_length >= min_length:
+            bits.append((0, 1))
+            bits.append((best_distance - 1, HEATSHRINK_WINDOW_BITS))
+            bits.append((best_length - 1, HEATSHRINK_LOOKAHEAD_BITS))
+        else:
+            best_length = 1
+            bits.append((1, 1))
+            bits.append((data[position], 8))
+        for i in range(position, position + best_length):
+            positions = candidates.setdefault(data[i:i + min_length], [])
+            positions.append(i)
+            if len(positions) > window_size:
+                del positions[0]
+        position += best_length
+
+    output = bytearray()
+    accumulator = 0
+    count = 0
+    for value, width in bits:
+        accumulator = (accumulator << width) | value
+        count += width
+        while count >= 8:
+            count -= 8
+            output.append((accumulator >> count) & 0xff)
+    if count > 0:
+        output.append((accumulator << (8 - count)) & 0xff)
+    return bytes(output)
+
+def write_bundle(output: str, resources: typing.List[typing.Tuple[str, str, bool]]):
+    """Packs the resources (target path, local file, compressible) in a single file, see components/fs/ResourceBundle.h"""
+    resources = sorted(resources, key=lambda resource: resource[0].encode())
+    header_size = 8
+    entry_size = BUNDLE_MAX_PATH_LENGTH + 12
+    offset = header_size + entry_size * len(resources)
+    index = b''
+    data = b''
+    for target_path, path, compressible in resources:
+        encoded_path = target_path.encode()
+        if len(encoded_path) >= BUNDLE_MAX_PATH_LENGTH:
+            sys.exit(f'Error: the resource path {target_path} is too long for the bundle.')
+        with open(path, 'rb') as fd:
+            content = fd.read()
+        # Resources that don't get smaller are stored as is (compressed size 0)
+        compressed = heatshrink_compress(content) if compressible else content
+        if len(compressed) < len(content):
+            stored = compressed
+            compressed_size = len(compressed)
+        else:
+            stored = content
+            compressed_size = 0
+        padding = (-len(stored)) % 4
+        index += struct.pack(f'<{BUNDLE_MAX_PATH_LENGTH}sIII', encoded_path, offset + len(data), len(content), compressed_size)
+        data += stored + b'\0' * padding
+    with open(output, 'wb') as fd:
+        fd.write(struct.pack('<4sHH', BUNDLE_MAGIC, BUNDLE_VERSION, len(resources)))
+        fd.write(index)
+        fd.write(data)
+
 def main():
     ap = argparse.ArgumentParser(description='auto generate LVGL font files from fonts')
     ap.add_argument('--config', '-c', type=str, action='append', help='config file to use')
@@ -32,6 +126,7 @@ def main():
 
     zf = ZipFile(args.output, mode='w')
     resource_files = []
+    bundled_resources = []
 
     for config_file in args.config:
         with open(config_file, 'r') as fd:
@@ -49,6 +144,17 @@ def main():
             if not os.path.exists(path):
                 path = os.path.join(os.path.dirname(sys.argv[0]), path)
             zf.write(path)
+            # Streamed fonts (displayapp/StreamingFont.h) read their glyphs at any offset, they can't be compressed
+            compressible = not resource.get('streamed', False)
+            bundled_resources.append((resource['target_path'] + name + '.bin', path, compressible))
+
+    # The resources are also installed individually, for the firmwares that don't read the bundle
+    write_bundle(BUNDLE_NAME, bundled_resources)
+    resource_files.append({
+        "filename": BUNDLE_NAME,
+        "path": BUNDLE_PATH
+    })
+    zf.write(BUNDLE_NAME)
 
     if args.obsolete:
         obsolete_file_path = os.path.join(os.path.dirname(sys.argv[0]), args.obsolete)
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+#include <mdk/nrf.h>
+
+namespace Pinetime {
+  namespace Utility {
+    // Cortex-M4 DWT cycle counter, used to profile hot paths on the device.
+    // The counter wraps every ~67s at 64MHz, so only measure short sections with it.
+    class CycleCounter {
+    public:
+      static void Enable() {
+        CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+        DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+      }
+
+      static uint32_t Now() {
+        return DWT->CYCCNT;
+      }
+
+      static constexpr uint64_t ToNanoseconds(uint32_t cycles) {
+        return (static_cast<uint64_t>(cycles) * 1000) / cyclesPerMicrosecond;
+      }
+
+      static constexpr uint32_t ToMicroseconds(uint32_t cycles) {
+        return cycles / cyclesPerMicrosecond;
+      }
+
+    private:
+      static constexpr uint32_t cyclesPerMicrosecond = 64;
+    };
+  }
+}
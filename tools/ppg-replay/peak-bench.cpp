@@ -0,0 +1,128 @@
+// Compares PeakSearch of the firmware with the previous version, which swept the region of interest in 0.01 bin steps
+// (before "Find the heart rate peak on the spectrum bins"), on synthetic spectra: a peak plus noise and spurious peaks.
+// Prints the cycles per call, how often both agree on finding a peak, and how far apart the peaks they find are.
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include "utility/CycleCounter.h"
+// PeakSearch is local to Ppg.cpp
+#include "components/heartrate/Ppg.cpp"
+
+using Pinetime::Utility::CycleCounter;
+
+namespace Previous {
+  float LinearInterpolation(const float* xValues, const float* yValues, int length, float pointX) {
+    if (pointX > xValues[length - 1]) {
+      return yValues[length - 1];
+    } else if (pointX <= xValues[0]) {
+      return yValues[0];
+    }
+    int index = 0;
+    while (pointX > xValues[index] && index < length - 1) {
+      index++;
+    }
+    float pointX0 = xValues[index - 1];
+    float pointX1 = xValues[index];
+    float pointY0 = yValues[index - 1];
+    float pointY1 = yValues[index];
+    float mu = (pointX - pointX0) / (pointX1 - pointX0);
+
+    return (pointY0 * (1 - mu) + pointY1 * mu);
+  }
+
+  float PeakSearch(float* xVals, float* yVals, float threshold, float& width, float start, float end, int length) {
+    int peaks = 0;
+    bool enabled = false;
+    float minBin = 0.0f;
+    float maxBin = 0.0f;
+    float peakCenter = 0.0f;
+    float prevValue = LinearInterpolation(xVals, yVals, length, start - 0.01f);
+    float currValue = LinearInterpolation(xVals, yVals, length, start);
+    float idx = start;
+    while (idx < end) {
+      float nextValue = LinearInterpolation(xVals, yVals, length, idx + 0.01f);
+      if (currValue < threshold) {
+        enabled = true;
+      }
+      if (currValue >= threshold and enabled) {
+        if (prevValue < threshold) {
+          minBin = idx;
+        } else if (nextValue <= threshold) {
+          maxBin = idx;
+          peaks++;
+          width = maxBin - minBin;
+          peakCenter = width / 2.0f + minBin;
+        }
+      }
+      prevValue = currValue;
+      currValue = nextValue;
+      idx += 0.01f;
+    }
+    if (peaks != 1) {
+      width = 0.0f;
+      peakCenter = 0.0f;
+    }
+    return peakCenter;
+  }
+
+}
+
+int main() {
+  constexpr int length = Ppg::spectrumLength;
+  constexpr int start = 3;
+  constexpr int end = 26;
+  constexpr int spectra = 2000;
+  std::mt19937 rng(7);
+  std::uniform_real_distribution<float> uniform(0, 1);
+  float bins[length];
+  for (int i = 0; i < length; i++) {
+    bins[i] = i;
+  }
+
+  double previousCycles = 0;
+  double cycles = 0;
+  int agree = 0;
+  int found = 0;
+  double centerDifference = 0;
+  double widthDifference = 0;
+  for (int n = 0; n < spectra; n++) {
+    float spectrum[length];
+    const float center = 4 + uniform(rng) * 20;
+    const float spread = 0.8f + uniform(rng) * 1.5f;
+    for (int i = 0; i < length; i++) {
+      spectrum[i] = 100 * std::exp(-(i - center) * (i - center) / (2 * spread * spread)) + 30 * uniform(rng);
+      if (uniform(rng) < 0.2f) {
+        spectrum[i] += 50 * std::exp(-std::pow(i - 4 - uniform(rng) * 20, 2));
+      }
+    }
+    const float threshold = 0.6f * *std::max_element(spectrum + start, spectrum + end);
+
+    float previousWidth = 0;
+    float width = 0;
+    const uint32_t t0 = CycleCounter::Now();
+    const float previousPeak = Previous::PeakSearch(bins, spectrum, threshold, previousWidth, start, end, length);
+    const uint32_t t1 = CycleCounter::Now();
+    const float peak = PeakSearch(spectrum, length, threshold, width, start, end);
+    const uint32_t t2 = CycleCounter::Now();
+    previousCycles += t1 - t0;
+    cycles += t2 - t1;
+
+    if ((previousPeak > 0) == (peak > 0)) {
+      agree++;
+    }
+    if (previousPeak > 0 && peak > 0) {
+      found++;
+      centerDifference += std::fabs(previousPeak - peak);
+      widthDifference += std::fabs(previousWidth - width);
+    }
+  }
+  std::printf("PeakSearch: %.0f cycles per call, previous version %.0f. Found/not found agree on %d/%d spectra, "
+              "mean difference %.3f bins on the center, %.3f on the width\n",
+              cycles / spectra,
+              previousCycles / spectra,
+              agree,
+              spectra,
+              centerDifference / found,
+              widthDifference / found);
+}
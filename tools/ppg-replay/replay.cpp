@@ -0,0 +1,243 @@
+// Replays heart rate sensor traces through the Ppg of the firmware, on the host.
+//
+//   ppg-replay trace.csv...   replays the traces, one sample per line at 10Hz: hrs,als[,reference bpm]
+//   ppg-replay [-v]           replays synthetic traces, -v prints every case
+//
+// For each trace, prints the error of the heart rate against the reference, the number of samples before the first
+// value and before two consecutive analyses agree (what ends a background measurement in HeartRateTask), and the cycles
+// spent per analysis. The output hash changes whenever any heart rate returned changes.
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+#include "components/heartrate/Ppg.h"
+
+using Pinetime::Controllers::Ppg;
+
+namespace {
+  // Same tolerance as HeartRateTask
+  constexpr int convergenceTolerance = 3;
+
+  struct Sample {
+    uint16_t hrs;
+    uint16_t als;
+    // Reference heart rate, 0 if unknown
+    float bpm;
+  };
+
+  struct Result {
+    // Number of samples before the first heart rate, and before two consecutive analyses agree, -1 if never
+    int firstValue = -1;
+    int converged = -1;
+    // Error of the heart rate at these samples
+    float firstValueError = 0;
+    float convergedError = 0;
+    int values = 0;
+    // Absolute error of the heart rates against the reference
+    double errorSum = 0;
+    int errorCount = 0;
+    Ppg::Statistics statistics;
+
+    double MeanError() const {
+      return errorCount > 0 ? errorSum / errorCount : -1;
+    }
+
+    double CyclesPerAnalysis() const {
+      return statistics.analyses > 0 ? static_cast<double>(statistics.cycles) / statistics.analyses : 0;
+    }
+  };
+
+  // FNV-1a of all the heart rates returned
+  uint64_t hash = 1469598103934665603ULL;
+
+  // Feeds the samples to Ppg as HeartRateTask::HandleSensorData() does
+  Result Replay(const std::vector<Sample>& samples) {
+    Ppg ppg;
+    Result result;
+    int lastAnalysis = 0;
+    for (size_t i = 0; i < samples.size(); i++) {
+      const int8_t ambient = ppg.Preprocess(samples[i].hrs, samples[i].als);
+      const int bpm = ppg.HeartRate();
+      hash = (hash ^ static_cast<uint32_t>(bpm)) * 1099511628211ULL;
+      if (ambient > 0) {
+        ppg.Reset(true);
+        lastAnalysis = 0;
+        continue;
+      }
+      if (bpm == -1) {
+        ppg.Reset(false);
+        lastAnalysis = 0;
+        continue;
+      }
+      if (bpm <= 0) {
+        continue;
+      }
+
+      const float error = (samples[i].bpm > 0) ? std::fabs(bpm - samples[i].bpm) : 0;
+      result.values++;
+      if (result.firstValue < 0) {
+        result.firstValue = i + 1;
+        result.firstValueError = error;
+      }
+      const int analysis = ppg.LastAnalysisHeartRate();
+      if (result.converged < 0 && lastAnalysis != 0 && analysis != 0 && std::abs(analysis - lastAnalysis) <= convergenceTolerance) {
+        result.converged = i + 1;
+        result.convergedError = error;
+      }
+      lastAnalysis = analysis;
+      if (samples[i].bpm > 0) {
+        result.errorSum += error;
+        result.errorCount++;
+      }
+    }
+    result.statistics = ppg.GetStatistics();
+    return result;
+  }
+
+  void Print(const char* name, const Result& result) {
+    std::printf("%s: error %6.2f bpm, first value after %4d samples, converged after %4d, %5d values, %8.0f cycles per analysis "
+                "(max %u)\n",
+                name,
+                result.MeanError(),
+                result.firstValue,
+                result.converged,
+                result.values,
+                result.CyclesPerAnalysis(),
+                result.statistics.maxCycles);
+  }
+
+  // HRS3300 signal: offset, slow drift, pulse (fundamental and harmonic) and noise. The heart rate ramps from bpm0
+  // to bpm1, and the signal jumps by step halfway (the sensor moved, or the ambient light changed).
+  std::vector<Sample> Synthetic(float bpm0, float bpm1, double noise, unsigned seed, int seconds, double step = 0) {
+    std::mt19937 rng(seed);
+    std::normal_distribution<double> normal(0, 1);
+    const int count = seconds * 1000 / Ppg::deltaTms;
+    std::vector<Sample> samples;
+    double phase = 0;
+    for (int i = 0; i < count; i++) {
+      const double t = i * Ppg::deltaTms / 1000.0;
+      const float bpm = bpm0 + (bpm1 - bpm0) * i / count;
+      phase += 2 * M_PI * bpm / 60.0 * Ppg::deltaTms / 1000.0;
+      double value = 8000 + 300 * std::sin(2 * M_PI * t / 37.0) + 60 * std::sin(phase) + 20 * std::sin(2 * phase + 0.5);
+      value += noise * normal(rng);
+      if (i >= count / 2) {
+        value += step;
+      }
+      value = std::clamp(value, 0.0, 65535.0);
+      samples.push_back({static_cast<uint16_t>(std::lround(value)), 100, bpm});
+    }
+    return samples;
+  }
+
+  bool ReadTrace(const char* path, std::vector<Sample>& samples) {
+    FILE* file = std::fopen(path, "r");
+    if (file == nullptr) {
+      return false;
+    }
+    char line[128];
+    while (std::fgets(line, sizeof(line), file) != nullptr) {
+      unsigned hrs;
+      unsigned als;
+      float bpm = 0;
+      // Headers, comments and the log prefix of HEARTRATE_TRACE lines are skipped
+      const char* values = std::strstr(line, "trace ");
+      values = (values != nullptr) ? values + 6 : line;
+      if (std::sscanf(values, "%u,%u,%f", &hrs, &als, &bpm) >= 2) {
+        samples.push_back({static_cast<uint16_t>(hrs), static_cast<uint16_t>(als), bpm});
+      }
+    }
+    std::fclose(file);
+    return true;
+  }
+
+  void ReplaySynthetic(bool verbose) {
+    constexpr float bpms[][2] = {{45, 45}, {60, 60}, {72, 80}, {95, 95}, {120, 110}, {150, 150}, {180, 170}};
+    constexpr double noises[] = {5, 20, 40};
+    char name[64];
+
+    // Accuracy over 2 minutes
+    double errorSum = 0;
+    double cyclesSum = 0;
+    int cases = 0;
+    for (const auto& bpm : bpms) {
+      for (double noise : noises) {
+        for (unsigned seed = 1; seed <= 3; seed++) {
+          const Result result = Replay(Synthetic(bpm[0], bpm[1], noise, seed, 120));
+          if (verbose) {
+            std::snprintf(name, sizeof(name), "bpm %3.0f->%3.0f noise %2.0f seed %u", bpm[0], bpm[1], noise, seed);
+            Print(name, result);
+          }
+          if (result.errorCount > 0) {
+            errorSum += result.MeanError();
+            cyclesSum += result.CyclesPerAnalysis();
+            cases++;
+          }
+        }
+      }
+    }
+
+    // Large steps of the raw value: the first difference is a spike that the FFT block scaling has to scale down
+    for (double step : {-7000.0, 20000.0, 50000.0}) {
+      for (float bpm : {60.0f, 120.0f}) {
+        std::snprintf(name, sizeof(name), "step %6.0f bpm %3.0f", step, bpm);
+        Print(name, Replay(Synthetic(bpm, bpm, 20, 1, 120, step)));
+      }
+    }
+    std::printf("%d cases with values, mean error %.3f bpm, %.0f cycles per analysis, output hash %llx\n",
+                cases,
+                errorSum / cases,
+                cyclesSum / cases,
+                static_cast<unsigned long long>(hash));
+
+    // Latency of a background measurement
+    int runs = 0;
+    double firstValueSum = 0;
+    double convergedSum = 0;
+    double firstValueErrorSum = 0;
+    double convergedErrorSum = 0;
+    for (const auto& bpm : bpms) {
+      for (double noise : noises) {
+        for (unsigned seed = 1; seed <= 20; seed++) {
+          const Result result = Replay(Synthetic(bpm[0], bpm[0], noise, seed, 30));
+          if (result.converged > 0) {
+            firstValueSum += result.firstValue;
+            convergedSum += result.converged;
+            firstValueErrorSum += result.firstValueError;
+            convergedErrorSum += result.convergedError;
+            runs++;
+          }
+        }
+      }
+    }
+    std::printf("%d runs of 30s converged: first value after %.1f samples (error %.2f bpm), converged after %.1f samples "
+                "(error %.2f bpm)\n",
+                runs,
+                firstValueSum / runs,
+                firstValueErrorSum / runs,
+                convergedSum / runs,
+                convergedErrorSum / runs);
+  }
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2 || std::strcmp(argv[1], "-v") == 0) {
+    ReplaySynthetic(argc > 1);
+    return 0;
+  }
+
+  int status = 0;
+  for (int i = 1; i < argc; i++) {
+    std::vector<Sample> samples;
+    if (!ReadTrace(argv[i], samples)) {
+      std::fprintf(stderr, "%s: can't be read\n", argv[i]);
+      status = 1;
+      continue;
+    }
+    Print(argv[i], Replay(samples));
+  }
+  std::printf("output hash %llx\n", static_cast<unsigned long long>(hash));
+  return status;
+}
@@ -0,0 +1,4 @@
+#pragma once
+
+// Host build of Ppg: logs are dropped
+#define NRF_LOG_INFO(...)
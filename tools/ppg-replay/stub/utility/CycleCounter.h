@@ -0,0 +1,24 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#if defined(__x86_64__) || defined(__i386__)
+  #include <x86intrin.h>
+#endif
+
+namespace Pinetime {
+  namespace Utility {
+    // Host replacement of the DWT cycle counter: TSC cycles on x86, nanoseconds elsewhere.
+    // Only the ratio between two builds is meaningful, not the count itself.
+    class CycleCounter {
+    public:
+      static uint32_t Now() {
+#if defined(__x86_64__) || defined(__i386__)
+        return static_cast<uint32_t>(__rdtsc());
+#else
+        return static_cast<uint32_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+      }
+    };
+  }
+}
@@ -268,6 +268,85 @@ def encode_8bit(im):
 
     return (im.width, im.height, bytes(rle))
 
+# LV_IMG_CF_USER_ENCODED_0, the colour format of the images decoded by displayapp/RleImageDecoder.h
+LVGL_CF_PALETTE_RLE = 24
+
+def encode_palette(im):
+    """Palette based RLE encoder for LVGL images.
+
+    The image is reduced to RGB565 and to at most 256 colours. Each line
+    is encoded as runs of one colour (1ccccccc index) or of literal colour
+    indices (0ccccccc index...), see components/rle/PaletteRleDecoder.h.
+    """
+    im = im.convert('RGB')
+    if len(set(im.getdata())) > 256:
+        im = im.quantize(256).convert('RGB')
+    pixels = im.load()
+
+    palette = []
+    indices = {}
+    def index_of(px):
+        rgb565 = ((px[0] & 0xf8) << 8) | ((px[1] & 0xfc) << 3) | (px[2] >> 3)
+        if rgb565 not in indices:
+            indices[rgb565] = len(palette)
+            palette.append(rgb565)
+        return indices[rgb565]
+
+    lines = []
+    for y in range(im.height):
+        lines.append([index_of(pixels[x, y]) for x in range(im.width)])
+
+    rle = [len(palette) - 1]
+    for color in palette:
+        rle += [color >> 8, color & 0xff]
+
+    for line in lines:
+        x = 0
+        literals = []
+        def flush_literals():
+            while literals:
+                chunk = literals[:128]
+                del literals[:128]
+                rle.append(len(chunk) - 1)
+                rle.extend(chunk)
+        while x < len(line):
+            run = 1
+            while x + run < len(line) and run < 128 and line[x + run] == line[x]:
+                run += 1
+            # A run of 2 costs as much as 2 literals, but breaks a sequence of literals
+            if run >= 3 or (run == 2 and not literals):
+                flush_literals()
+                rle += [0x80 | (run - 1), line[x]]
+            else:
+                literals.extend(line[x:x + run])
+            x += run
+        flush_literals()
+
+    return (im.width, im.height, bytes(rle))
+
+def render_lvgl_c(image, fname, indent):
+    extra_indent = ' ' * indent
+    (x, y, data) = image
+    name = varname(fname)
+    print(f'{extra_indent}// Palette RLE, generated from {fname}, {len(data)} bytes')
+    print(f'{extra_indent}static const uint8_t {name}_map[] = {{')
+    for i in range(0, len(data), 12):
+        print(f'{extra_indent}  ' + ' '.join(f'{hex(b)},' for b in data[i:i+12]))
+    print(f'{extra_indent}}};')
+    print()
+    print(f'{extra_indent}const lv_img_dsc_t {name} = {{')
+    print(f'{extra_indent}  .header = {{.cf = LV_IMG_CF_USER_ENCODED_0, .always_zero = 0, .reserved = 0, .w = {x}, .h = {y}}},')
+    print(f'{extra_indent}  .data_size = {len(data)},')
+    print(f'{extra_indent}  .data = {name}_map,')
+    print(f'{extra_indent}}};')
+
+def write_lvgl_bin(image, fname):
+    (x, y, data) = image
+    header = LVGL_CF_PALETTE_RLE | (x << 10) | (y << 21)
+    with open(varname(fname) + '.bin', 'wb') as fd:
+        fd.write(header.to_bytes(4, 'little'))
+        fd.write(data)
+
 def render_c(image, fname, indent, depth):
     extra_indent = ' ' * indent
     if len(image) == 3:
@@ -354,9 +433,14 @@ parser.add_argument('--2bit', action='store_true', dest='twobit',
                     help='Generate 2-bit image')
 parser.add_argument('--8bit', action='store_true', dest='eightbit',
                     help='Generate 8-bit image')
+parser.add_argument('--lvgl', action='store_true',
+                    help='Generate a palette RLE image for LVGL, written to <name>.bin (or as C with --c)')
 
 args = parser.parse_args()
-if args.eightbit:
+if args.lvgl:
+    encoder = encode_palette
+    depth = 16
+elif args.eightbit:
     encoder = encode_8bit
     depth = 8
 elif args.twobit:
@@ -369,7 +453,12 @@ else:
 for fname in args.files:
     image = encoder(Image.open(fname))
 
-    if args.c:
+    if args.lvgl:
+        if args.c:
+            render_lvgl_c(image, fname, args.indent)
+        else:
+            write_lvgl_bin(image, fname)
+    elif args.c:
         render_c(image, fname, args.indent, depth)
     else:
         render_py(image, fname, args.indent, depth)